@@ -0,0 +1,92 @@
+#include "engine/aabb.h"
+
+// NOTE(SeedyROM): AABB_SCALAR forces the one box at a time path, the tests build it every way to check them against each other.
+#if defined(AABB_SCALAR)
+#define AABB_LANES 1
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define AABB_LANES 8
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#define AABB_LANES 4
+#else
+#define AABB_LANES 1
+#endif
+
+void AABBBatchInit(Arena *arena, AABBBatch *batch, u32 capacity) {
+    batch->minX = ArenaPushArray(arena, capacity, f32);
+    batch->minY = ArenaPushArray(arena, capacity, f32);
+    batch->maxX = ArenaPushArray(arena, capacity, f32);
+    batch->maxY = ArenaPushArray(arena, capacity, f32);
+    batch->hits = ArenaPushArray(arena, capacity, u32);
+    batch->count = 0;
+    batch->capacity = capacity;
+}
+
+void AABBBatchClear(AABBBatch *batch) {
+    batch->count = 0;
+}
+
+u32 AABBBatchPush(AABBBatch *batch, SDL_FRect box) {
+    if (batch->count == batch->capacity) {
+        printf("AABBBatchPush: batch is full\n");
+        exit(EXIT_FAILURE);
+    }
+
+    u32 index = batch->count++;
+    batch->minX[index] = box.x;
+    batch->minY[index] = box.y;
+    batch->maxX[index] = box.x + box.w;
+    batch->maxY[index] = box.y + box.h;
+
+    return index;
+}
+
+static inline u32 AABBBatchOverlapScalar(AABBBatch *batch, u32 index, f32 minX, f32 minY, f32 maxX, f32 maxY) {
+    return batch->minX[index] < maxX && minX < batch->maxX[index] &&
+           batch->minY[index] < maxY && minY < batch->maxY[index];
+}
+
+// Overlap bits for the boxes [start, start + AABB_LANES), bit N is box start + N
+static inline u32 AABBBatchOverlapLanes(AABBBatch *batch, u32 start, f32 minX, f32 minY, f32 maxX, f32 maxY) {
+#if AABB_LANES == 8
+    __m256 overlap = _mm256_and_ps(
+        _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(batch->minX + start), _mm256_set1_ps(maxX), _CMP_LT_OQ),
+                      _mm256_cmp_ps(_mm256_set1_ps(minX), _mm256_loadu_ps(batch->maxX + start), _CMP_LT_OQ)),
+        _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(batch->minY + start), _mm256_set1_ps(maxY), _CMP_LT_OQ),
+                      _mm256_cmp_ps(_mm256_set1_ps(minY), _mm256_loadu_ps(batch->maxY + start), _CMP_LT_OQ)));
+    return (u32)_mm256_movemask_ps(overlap);
+#elif AABB_LANES == 4
+    __m128 overlap = _mm_and_ps(
+        _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(batch->minX + start), _mm_set1_ps(maxX)),
+                   _mm_cmplt_ps(_mm_set1_ps(minX), _mm_loadu_ps(batch->maxX + start))),
+        _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(batch->minY + start), _mm_set1_ps(maxY)),
+                   _mm_cmplt_ps(_mm_set1_ps(minY), _mm_loadu_ps(batch->maxY + start))));
+    return (u32)_mm_movemask_ps(overlap);
+#else
+    return AABBBatchOverlapScalar(batch, start, minX, minY, maxX, maxY);
+#endif
+}
+
+u32 AABBBatchOverlapBox(AABBBatch *batch, SDL_FRect box) {
+    u32 *indices = batch->hits;
+    f32 minX = box.x, minY = box.y, maxX = box.x + box.w, maxY = box.y + box.h;
+
+    // Write the hit indices without branching on every box
+    u32 count = 0;
+    u32 i = 0;
+    for (; i + AABB_LANES <= batch->count; i += AABB_LANES) {
+        u32 bits = AABBBatchOverlapLanes(batch, i, minX, minY, maxX, maxY);
+        while (bits != 0) {
+            indices[count++] = i + __builtin_ctz(bits);
+            bits &= bits - 1;
+        }
+    }
+
+    for (; i < batch->count; i++) {
+        indices[count] = i;
+        count += AABBBatchOverlapScalar(batch, i, minX, minY, maxX, maxY);
+    }
+
+    return count;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include "engine/arena.h"
+#include "engine/util.h"
+
+// Boxes stored as separate min/max columns so overlap tests run 4 (SSE) or
+// 8 (AVX) boxes at a time. Overlap is strict, touching edges don't count.
+// AABBBatchOverlapBox writes the indices it hits into hits.
+typedef struct AABBBatch {
+  f32 *minX;
+  f32 *minY;
+  f32 *maxX;
+  f32 *maxY;
+  u32 *hits;
+  u32 count;
+  u32 capacity;
+} AABBBatch;
+
+typedef struct AABBPair {
+  u32 a;
+  u32 b;
+} AABBPair;
+
+void AABBBatchInit(Arena *arena, AABBBatch *batch, u32 capacity);
+void AABBBatchClear(AABBBatch *batch);
+u32 AABBBatchPush(AABBBatch *batch, SDL_FRect box);
+u32 AABBBatchOverlapBox(AABBBatch *batch, SDL_FRect box);
@@ -54,3 +54,24 @@ void ArenaSetPositionBack(Arena *arena, usize position) {
 void ArenaClear(Arena *arena) {
     arena->used = 0;
 }
+
+void ArenaSnapshotInit(Arena *arena, ArenaSnapshot *snapshot, usize capacity) {
+    snapshot->memory = ArenaPush(arena, capacity);
+    snapshot->capacity = capacity;
+    snapshot->used = 0;
+}
+
+void ArenaSnapshotSave(ArenaSnapshot *snapshot, Arena *source) {
+    if (source->used > snapshot->capacity) {
+        printf("Arena snapshot overflow\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(snapshot->memory, source->base, source->used);
+    snapshot->used = source->used;
+}
+
+void ArenaSnapshotRestore(ArenaSnapshot *snapshot, Arena *target) {
+    // NOTE(SeedyROM): Anything pushed after the save just gets forgotten, same as ArenaSetPositionBack.
+    memcpy(target->base, snapshot->memory, snapshot->used);
+    target->used = snapshot->used;
+}
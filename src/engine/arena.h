@@ -31,6 +31,19 @@ void ArenaClear(Arena *arena);
 #define ArenaPopStruct(arena, type) ArenaPop(arena, sizeof(type))
 #define ArenaPopArray(arena, count, type) ArenaPop(arena, (count) * sizeof(type))
 
+// A copy of everything pushed onto an arena. Restoring puts the same bytes
+// back at the same addresses, so pointers into the arena stay valid as long as
+// it's the arena the snapshot was taken from.
+typedef struct ArenaSnapshot {
+    void *memory;
+    usize capacity;
+    usize used;
+} ArenaSnapshot;
+
+void ArenaSnapshotInit(Arena *arena, ArenaSnapshot *snapshot, usize capacity);
+void ArenaSnapshotSave(ArenaSnapshot *snapshot, Arena *source);
+void ArenaSnapshotRestore(ArenaSnapshot *snapshot, Arena *target);
+
 typedef struct TempMemory {
     Arena *arena;
     usize position;
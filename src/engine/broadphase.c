@@ -0,0 +1,302 @@
+#include "engine/broadphase.h"
+
+#include <math.h>
+
+static inline u32 SpatialHashBucket(SpatialHash *hash, i32 cellX, i32 cellY) {
+    return (((u32)cellX * 73856093u) ^ ((u32)cellY * 19349663u)) & hash->bucketMask;
+}
+
+static inline i32 SpatialHashCell(SpatialHash *hash, f32 position) {
+    return (i32)floorf(position * hash->inverseCellSize);
+}
+
+static inline bool SpatialHashBoxesTouch(SDL_FRect *a, SDL_FRect *b) {
+    return a->x <= b->x + b->w && b->x <= a->x + a->w &&
+           a->y <= b->y + b->h && b->y <= a->y + a->h;
+}
+
+void SpatialHashInit(Arena *arena, SpatialHash *hash, f32 cellSize, u32 bucketCount, u32 idCapacity, u32 nodeCapacity) {
+    // Bucket count has to be a power of two for the mask
+    u32 buckets = 1;
+    while (buckets < bucketCount) {
+        buckets <<= 1;
+    }
+
+    hash->cellSize = cellSize;
+    hash->inverseCellSize = 1.0f / cellSize;
+    hash->bucketMask = buckets - 1;
+    hash->buckets = ArenaPushArray(arena, buckets, u32);
+    hash->nodes = ArenaPushArray(arena, nodeCapacity, SpatialHashNode);
+    hash->nodeCapacity = nodeCapacity;
+    hash->items = ArenaPushArray(arena, idCapacity, SpatialHashItem);
+    hash->idCapacity = idCapacity;
+
+    SpatialHashClear(hash);
+}
+
+void SpatialHashClear(SpatialHash *hash) {
+    memset(hash->buckets, 0xFF, (hash->bucketMask + 1) * sizeof(u32));
+    memset(hash->items, 0, hash->idCapacity * sizeof(SpatialHashItem));
+    hash->nodeCount = 0;
+    hash->freeNode = SpatialHashEmpty;
+    hash->queryStamp = 0;
+}
+
+static void SpatialHashLink(SpatialHash *hash, u32 id, u32 bucket) {
+    u32 nodeIndex = hash->freeNode;
+    if (nodeIndex != SpatialHashEmpty) {
+        hash->freeNode = hash->nodes[nodeIndex].next;
+    } else {
+        if (hash->nodeCount == hash->nodeCapacity) {
+            printf("SpatialHashInsert: out of nodes\n");
+            exit(EXIT_FAILURE);
+        }
+        nodeIndex = hash->nodeCount++;
+    }
+
+    SpatialHashNode *node = &hash->nodes[nodeIndex];
+    node->id = id;
+    node->next = hash->buckets[bucket];
+    hash->buckets[bucket] = nodeIndex;
+}
+
+static void SpatialHashUnlink(SpatialHash *hash, u32 id, u32 bucket) {
+    u32 *link = &hash->buckets[bucket];
+    while (*link != SpatialHashEmpty) {
+        u32 nodeIndex = *link;
+        SpatialHashNode *node = &hash->nodes[nodeIndex];
+        if (node->id == id) {
+            *link = node->next;
+            node->next = hash->freeNode;
+            hash->freeNode = nodeIndex;
+            return;
+        }
+        link = &node->next;
+    }
+}
+
+void SpatialHashInsert(SpatialHash *hash, u32 id, SDL_FRect box) {
+    if (id >= hash->idCapacity) {
+        printf("SpatialHashInsert: id out of bounds\n");
+        return;
+    }
+
+    SpatialHashItem *item = &hash->items[id];
+    if (item->active) {
+        SpatialHashRemove(hash, id);
+    }
+
+    item->box = box;
+    item->minCellX = SpatialHashCell(hash, box.x);
+    item->minCellY = SpatialHashCell(hash, box.y);
+    item->maxCellX = SpatialHashCell(hash, box.x + box.w);
+    item->maxCellY = SpatialHashCell(hash, box.y + box.h);
+    item->queryStamp = hash->queryStamp;
+    item->active = true;
+
+    for (i32 y = item->minCellY; y <= item->maxCellY; y++) {
+        for (i32 x = item->minCellX; x <= item->maxCellX; x++) {
+            SpatialHashLink(hash, id, SpatialHashBucket(hash, x, y));
+        }
+    }
+}
+
+void SpatialHashRemove(SpatialHash *hash, u32 id) {
+    if (id >= hash->idCapacity || !hash->items[id].active) {
+        return;
+    }
+
+    SpatialHashItem *item = &hash->items[id];
+    for (i32 y = item->minCellY; y <= item->maxCellY; y++) {
+        for (i32 x = item->minCellX; x <= item->maxCellX; x++) {
+            SpatialHashUnlink(hash, id, SpatialHashBucket(hash, x, y));
+        }
+    }
+
+    item->active = false;
+}
+
+void SpatialHashUpdate(SpatialHash *hash, u32 id, SDL_FRect box) {
+    if (id >= hash->idCapacity) {
+        printf("SpatialHashUpdate: id out of bounds\n");
+        return;
+    }
+
+    SpatialHashItem *item = &hash->items[id];
+    if (!item->active) {
+        SpatialHashInsert(hash, id, box);
+        return;
+    }
+
+    // Most movers stay inside the same cells, only the box needs to change
+    if (SpatialHashCell(hash, box.x) == item->minCellX &&
+        SpatialHashCell(hash, box.y) == item->minCellY &&
+        SpatialHashCell(hash, box.x + box.w) == item->maxCellX &&
+        SpatialHashCell(hash, box.y + box.h) == item->maxCellY) {
+        item->box = box;
+        return;
+    }
+
+    SpatialHashRemove(hash, id);
+    SpatialHashInsert(hash, id, box);
+}
+
+u32 SpatialHashQuery(SpatialHash *hash, SDL_FRect box, u32 *results, u32 maxResults) {
+    // Stamp every item we visit so ids spanning several cells are only returned once
+    hash->queryStamp++;
+
+    i32 minCellX = SpatialHashCell(hash, box.x);
+    i32 minCellY = SpatialHashCell(hash, box.y);
+    i32 maxCellX = SpatialHashCell(hash, box.x + box.w);
+    i32 maxCellY = SpatialHashCell(hash, box.y + box.h);
+
+    u32 count = 0;
+    for (i32 y = minCellY; y <= maxCellY; y++) {
+        for (i32 x = minCellX; x <= maxCellX; x++) {
+            u32 nodeIndex = hash->buckets[SpatialHashBucket(hash, x, y)];
+            while (nodeIndex != SpatialHashEmpty) {
+                SpatialHashNode *node = &hash->nodes[nodeIndex];
+                nodeIndex = node->next;
+
+                SpatialHashItem *item = &hash->items[node->id];
+                if (item->queryStamp == hash->queryStamp) {
+                    continue;
+                }
+                item->queryStamp = hash->queryStamp;
+
+                // Different cells can share a bucket, so check the box too
+                if (!SpatialHashBoxesTouch(&item->box, &box)) {
+                    continue;
+                }
+
+                if (count == maxResults) {
+                    printf("SpatialHashQuery: results are full\n");
+                    return count;
+                }
+                results[count++] = node->id;
+            }
+        }
+    }
+
+    return count;
+}
+
+void SweepAndPruneInit(Arena *arena, SweepAndPrune *sap, u32 bodyCapacity) {
+    sap->boxes = ArenaPushArray(arena, bodyCapacity, SDL_FRect);
+    sap->active = ArenaPushArrayZero(arena, bodyCapacity, bool);
+    sap->bodyCapacity = bodyCapacity;
+    sap->endpoints = ArenaPushArray(arena, bodyCapacity * 2, SweepEndpoint);
+    sap->endpointCount = 0;
+}
+
+void SweepAndPruneAdd(SweepAndPrune *sap, u32 body, SDL_FRect box) {
+    if (body >= sap->bodyCapacity || sap->active[body]) {
+        printf("SweepAndPruneAdd: invalid body\n");
+        return;
+    }
+
+    sap->boxes[body] = box;
+    sap->active[body] = true;
+
+    // New endpoints go on the end, the next sort moves them into place
+    sap->endpoints[sap->endpointCount++] = (SweepEndpoint){box.x, body, false};
+    sap->endpoints[sap->endpointCount++] = (SweepEndpoint){box.x + box.w, body, true};
+}
+
+void SweepAndPruneRemove(SweepAndPrune *sap, u32 body) {
+    if (body >= sap->bodyCapacity || !sap->active[body]) {
+        return;
+    }
+
+    sap->active[body] = false;
+
+    // Close the gaps without disturbing the order
+    u32 kept = 0;
+    for (u32 i = 0; i < sap->endpointCount; i++) {
+        if (sap->endpoints[i].body != body) {
+            sap->endpoints[kept++] = sap->endpoints[i];
+        }
+    }
+    sap->endpointCount = kept;
+}
+
+void SweepAndPruneUpdate(SweepAndPrune *sap, u32 body, SDL_FRect box) {
+    if (body >= sap->bodyCapacity || !sap->active[body]) {
+        printf("SweepAndPruneUpdate: invalid body\n");
+        return;
+    }
+
+    sap->boxes[body] = box;
+}
+
+// Touching isn't overlapping, so a max sorts before a min at the same spot,
+// unless they're the same zero width body
+static inline bool SweepEndpointGreater(SweepEndpoint *a, SweepEndpoint *b) {
+    if (a->value != b->value) {
+        return a->value > b->value;
+    }
+
+    if (a->body == b->body) {
+        return a->isMax && !b->isMax;
+    }
+
+    return !a->isMax && b->isMax;
+}
+
+u32 SweepAndPruneFindPairs(SweepAndPrune *sap, Arena *frameArena, AABBPair **pairs) {
+    // Pull the latest boxes into the endpoints
+    for (u32 i = 0; i < sap->endpointCount; i++) {
+        SweepEndpoint *endpoint = &sap->endpoints[i];
+        SDL_FRect *box = &sap->boxes[endpoint->body];
+        endpoint->value = endpoint->isMax ? box->x + box->w : box->x;
+    }
+
+    // Insertion sort, bodies only move a little between ticks
+    for (u32 i = 1; i < sap->endpointCount; i++) {
+        SweepEndpoint endpoint = sap->endpoints[i];
+        u32 j = i;
+        while (j > 0 && SweepEndpointGreater(&sap->endpoints[j - 1], &endpoint)) {
+            sap->endpoints[j] = sap->endpoints[j - 1];
+            j--;
+        }
+        sap->endpoints[j] = endpoint;
+    }
+
+    // Bodies whose x span we're currently inside
+    u32 *open = ArenaPushArray(frameArena, sap->bodyCapacity, u32);
+    u32 *openIndex = ArenaPushArray(frameArena, sap->bodyCapacity, u32);
+    u32 openCount = 0;
+
+    // Pairs are pushed one after another, so they end up contiguous in the frame arena
+    *pairs = (AABBPair *)((u8 *)frameArena->base + frameArena->used);
+    u32 pairCount = 0;
+
+    for (u32 i = 0; i < sap->endpointCount; i++) {
+        SweepEndpoint *endpoint = &sap->endpoints[i];
+        u32 body = endpoint->body;
+
+        if (endpoint->isMax) {
+            u32 index = openIndex[body];
+            open[index] = open[--openCount];
+            openIndex[open[index]] = index;
+            continue;
+        }
+
+        // Everything still open overlaps on x, bar zero width ties, check y
+        SDL_FRect *box = &sap->boxes[body];
+        for (u32 j = 0; j < openCount; j++) {
+            SDL_FRect *other = &sap->boxes[open[j]];
+            if (box->x < other->x + other->w && other->x < box->x + box->w &&
+                box->y < other->y + other->h && other->y < box->y + box->h) {
+                AABBPair *pair = ArenaPushStruct(frameArena, AABBPair);
+                *pair = (AABBPair){MIN(body, open[j]), MAX(body, open[j])};
+                pairCount++;
+            }
+        }
+
+        openIndex[body] = openCount;
+        open[openCount++] = body;
+    }
+
+    return pairCount;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#include "engine/aabb.h"
+#include "engine/arena.h"
+#include "engine/util.h"
+
+static const u32 SpatialHashEmpty = 0xFFFFFFFF;
+
+typedef struct SpatialHashNode {
+  u32 id;
+  u32 next;
+} SpatialHashNode;
+
+typedef struct SpatialHashItem {
+  SDL_FRect box;
+  i32 minCellX;
+  i32 minCellY;
+  i32 maxCellX;
+  i32 maxCellY;
+  u32 queryStamp;
+  bool active;
+} SpatialHashItem;
+
+// Uniform grid hashed into a fixed number of buckets. Items are addressed by
+// caller picked ids below idCapacity and can span several cells.
+typedef struct SpatialHash {
+  f32 cellSize;
+  f32 inverseCellSize;
+  u32 bucketMask;
+  u32 *buckets;
+  SpatialHashNode *nodes;
+  u32 nodeCapacity;
+  u32 nodeCount;
+  u32 freeNode;
+  SpatialHashItem *items;
+  u32 idCapacity;
+  u32 queryStamp;
+} SpatialHash;
+
+void SpatialHashInit(Arena *arena, SpatialHash *hash, f32 cellSize,
+                     u32 bucketCount, u32 idCapacity, u32 nodeCapacity);
+void SpatialHashClear(SpatialHash *hash);
+void SpatialHashInsert(SpatialHash *hash, u32 id, SDL_FRect box);
+void SpatialHashRemove(SpatialHash *hash, u32 id);
+void SpatialHashUpdate(SpatialHash *hash, u32 id, SDL_FRect box);
+u32 SpatialHashQuery(SpatialHash *hash, SDL_FRect box, u32 *results,
+                     u32 maxResults);
+
+typedef struct SweepEndpoint {
+  f32 value;
+  u32 body;
+  bool isMax;
+} SweepEndpoint;
+
+// Sort-and-sweep on the x axis for bodies that move every tick. Endpoints stay
+// sorted between ticks, so re-sorting with insertion sort is close to linear.
+typedef struct SweepAndPrune {
+  SDL_FRect *boxes;
+  bool *active;
+  u32 bodyCapacity;
+  SweepEndpoint *endpoints;
+  u32 endpointCount;
+} SweepAndPrune;
+
+void SweepAndPruneInit(Arena *arena, SweepAndPrune *sap, u32 bodyCapacity);
+void SweepAndPruneAdd(SweepAndPrune *sap, u32 body, SDL_FRect box);
+void SweepAndPruneRemove(SweepAndPrune *sap, u32 body);
+void SweepAndPruneUpdate(SweepAndPrune *sap, u32 body, SDL_FRect box);
+u32 SweepAndPruneFindPairs(SweepAndPrune *sap, Arena *frameArena,
+                           AABBPair **pairs);
@@ -0,0 +1,60 @@
+#include "engine/capture.h"
+
+// FNV-1a, run over whole pixels instead of bytes
+static const u64 FrameCaptureHashBasis = 0xCBF29CE484222325ull;
+static const u64 FrameCaptureHashPrime = 0x100000001B3ull;
+
+FrameCapture *FrameCaptureCreate(Arena *arena, u16 width, u16 height) {
+    FrameCapture *capture = ArenaPushStruct(arena, FrameCapture);
+    capture->width = width;
+    capture->height = height;
+    capture->pixels = ArenaPushArrayZero(arena, width * height, u32);
+    capture->frameIndex = 0;
+    capture->hash = 0;
+
+    return capture;
+}
+
+int FrameCaptureRead(FrameCapture *capture, SDL_Renderer *renderer) {
+    // NOTE(SeedyROM): This has to happen before SDL_RenderPresent, the backbuffer
+    // is undefined after presenting.
+    int result = SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ABGR8888, capture->pixels, capture->width * sizeof(u32));
+    if (result != 0) {
+        fprintf(stderr, "SDL_RenderReadPixels Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    capture->hash = FrameCaptureHash(capture);
+    capture->frameIndex++;
+
+    return 0;
+}
+
+u64 FrameCaptureHash(FrameCapture *capture) {
+    u64 hash = FrameCaptureHashBasis;
+    usize count = capture->width * capture->height;
+    for (usize i = 0; i < count; i++) {
+        hash ^= capture->pixels[i];
+        hash *= FrameCaptureHashPrime;
+    }
+
+    return hash;
+}
+
+int FrameCaptureWriteBMP(FrameCapture *capture, String *path) {
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom(capture->pixels, capture->width, capture->height, 32, capture->width * sizeof(u32), SDL_PIXELFORMAT_ABGR8888);
+    if (surface == NULL) {
+        fprintf(stderr, "SDL_CreateRGBSurfaceWithFormatFrom Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    int result = SDL_SaveBMP(surface, path->ptr);
+    SDL_FreeSurface(surface);
+
+    if (result != 0) {
+        fprintf(stderr, "SDL_SaveBMP Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    return 0;
+}
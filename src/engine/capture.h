@@ -0,0 +1,23 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+
+#include "engine/arena.h"
+#include "engine/str.h"
+#include "engine/util.h"
+
+// Reads rendered frames back into arena memory so they can be hashed and
+// compared between runs, or dumped to disk for inspection.
+typedef struct FrameCapture {
+  u16 width;
+  u16 height;
+  u32 *pixels;
+  u32 frameIndex;
+  u64 hash;
+} FrameCapture;
+
+FrameCapture *FrameCaptureCreate(Arena *arena, u16 width, u16 height);
+int FrameCaptureRead(FrameCapture *capture, SDL_Renderer *renderer);
+u64 FrameCaptureHash(FrameCapture *capture);
+int FrameCaptureWriteBMP(FrameCapture *capture, String *path);
@@ -0,0 +1,32 @@
+#include "engine/clock.h"
+
+static const u32 SimClockMaxTicksPerFrame = 5;
+
+void SimClockInit(SimClock *clock, u32 tickRate) {
+    clock->tickRate = tickRate;
+    clock->frequency = SDL_GetPerformanceFrequency();
+    clock->tickDuration = clock->frequency / tickRate;
+    clock->lastCounter = SDL_GetPerformanceCounter();
+    clock->accumulator = 0;
+    clock->maxTicksPerFrame = SimClockMaxTicksPerFrame;
+    clock->tick = 0;
+}
+
+// How many ticks to simulate this frame
+u32 SimClockAdvance(SimClock *clock) {
+    u64 counter = SDL_GetPerformanceCounter();
+    clock->accumulator += counter - clock->lastCounter;
+    clock->lastCounter = counter;
+
+    // NOTE(SeedyROM): Drop time we can't catch up on (breakpoints, window drags),
+    // otherwise every frame gets slower trying to pay it back.
+    u64 maxAccumulator = clock->tickDuration * clock->maxTicksPerFrame;
+    if (clock->accumulator > maxAccumulator) {
+        clock->accumulator = maxAccumulator;
+    }
+
+    u32 ticks = clock->accumulator / clock->tickDuration;
+    clock->accumulator -= ticks * clock->tickDuration;
+
+    return ticks;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include "engine/util.h"
+
+// Fixed timestep clock. Real time goes into the accumulator every frame and
+// comes out in whole ticks, whatever is left over waits for the next frame.
+// Drawing doesn't use the leftover, it interpolates from when each snapshot
+// was taken.
+typedef struct SimClock {
+  u32 tickRate;
+  u64 frequency;
+  u64 tickDuration;
+  u64 lastCounter;
+  u64 accumulator;
+  // Stops a slow frame from asking for more ticks than we can catch up on
+  u32 maxTicksPerFrame;
+  u64 tick;
+} SimClock;
+
+void SimClockInit(SimClock *clock, u32 tickRate);
+u32 SimClockAdvance(SimClock *clock);
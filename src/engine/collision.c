@@ -0,0 +1,125 @@
+#include "engine/collision.h"
+
+#include <math.h>
+
+// Slides per move, enough to hit a floor and a wall in the same tick
+static const u32 CollisionMaxSlides = 3;
+
+// Contacts a hair in the past still count, float error can leave boxes just touching
+static const f32 CollisionTimeEpsilon = 1e-4f;
+
+bool CollisionSweepAABB(SDL_FRect moving, Vec2 delta, SDL_FRect target, CollisionHit *hit) {
+    f32 entryX, exitX, entryY, exitY;
+
+    // Times the moving box starts and stops overlapping on each axis
+    if (delta.x == 0) {
+        if (moving.x >= target.x + target.w || target.x >= moving.x + moving.w) {
+            return false;
+        }
+        entryX = -INFINITY;
+        exitX = INFINITY;
+    } else if (delta.x > 0) {
+        entryX = (target.x - (moving.x + moving.w)) / delta.x;
+        exitX = (target.x + target.w - moving.x) / delta.x;
+    } else {
+        entryX = (target.x + target.w - moving.x) / delta.x;
+        exitX = (target.x - (moving.x + moving.w)) / delta.x;
+    }
+
+    if (delta.y == 0) {
+        if (moving.y >= target.y + target.h || target.y >= moving.y + moving.h) {
+            return false;
+        }
+        entryY = -INFINITY;
+        exitY = INFINITY;
+    } else if (delta.y > 0) {
+        entryY = (target.y - (moving.y + moving.h)) / delta.y;
+        exitY = (target.y + target.h - moving.y) / delta.y;
+    } else {
+        entryY = (target.y + target.h - moving.y) / delta.y;
+        exitY = (target.y - (moving.y + moving.h)) / delta.y;
+    }
+
+    f32 entry = MAX(entryX, entryY);
+    f32 exit = MIN(exitX, exitY);
+
+    // Already overlapping, moving apart or not reaching it this tick
+    if (entry >= exit || entry < -CollisionTimeEpsilon || entry > 1.0f) {
+        return false;
+    }
+
+    hit->time = MAX(entry, 0.0f);
+    if (entryX > entryY) {
+        hit->normal = (Vec2){delta.x > 0 ? -1.0f : 1.0f, 0};
+    } else {
+        hit->normal = (Vec2){0, delta.y > 0 ? -1.0f : 1.0f};
+    }
+
+    return true;
+}
+
+void CollisionMoveAndSlide(CollisionMover *mover, SDL_FRect *obstacles, u32 obstacleCount) {
+    Vec2 remaining = mover->delta;
+    mover->normal = (Vec2){0, 0};
+
+    for (u32 slide = 0; slide < CollisionMaxSlides; slide++) {
+        if (remaining.x == 0 && remaining.y == 0) {
+            break;
+        }
+
+        // Find the first thing we'd run into
+        CollisionHit first = {.time = INFINITY};
+        SDL_FRect *firstObstacle = NULL;
+        for (u32 i = 0; i < obstacleCount; i++) {
+            CollisionHit hit;
+            if (CollisionSweepAABB(mover->box, remaining, obstacles[i], &hit) && hit.time < first.time) {
+                first = hit;
+                firstObstacle = &obstacles[i];
+            }
+        }
+
+        if (firstObstacle == NULL) {
+            mover->box.x += remaining.x;
+            mover->box.y += remaining.y;
+            break;
+        }
+
+        // Move up to the contact and snap flush against it so error can't build up
+        mover->box.x += remaining.x * first.time;
+        mover->box.y += remaining.y * first.time;
+        if (first.normal.x < 0) {
+            mover->box.x = firstObstacle->x - mover->box.w;
+        } else if (first.normal.x > 0) {
+            mover->box.x = firstObstacle->x + firstObstacle->w;
+        } else if (first.normal.y < 0) {
+            mover->box.y = firstObstacle->y - mover->box.h;
+        } else {
+            mover->box.y = firstObstacle->y + firstObstacle->h;
+        }
+
+        // Slide along the surface with whatever movement is left
+        remaining.x *= 1.0f - first.time;
+        remaining.y *= 1.0f - first.time;
+        if (first.normal.x != 0) {
+            remaining.x = 0;
+            mover->normal.x = first.normal.x;
+        } else {
+            remaining.y = 0;
+            mover->normal.y = first.normal.y;
+        }
+    }
+}
+
+SDL_FRect CollisionGetSweptBounds(SDL_FRect box, Vec2 delta) {
+    SDL_FRect bounds = box;
+    if (delta.x < 0) {
+        bounds.x += delta.x;
+    }
+    if (delta.y < 0) {
+        bounds.y += delta.y;
+    }
+    bounds.w += fabsf(delta.x);
+    bounds.h += fabsf(delta.y);
+
+    return bounds;
+}
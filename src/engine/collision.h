@@ -0,0 +1,25 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#include "engine/util.h"
+
+typedef struct CollisionHit {
+  f32 time;
+  Vec2 normal;
+} CollisionHit;
+
+// A box that wants to move by delta this tick. After moving, normal holds the
+// contact normal seen on each axis (0 when that axis was never blocked).
+typedef struct CollisionMover {
+  SDL_FRect box;
+  Vec2 delta;
+  Vec2 normal;
+} CollisionMover;
+
+bool CollisionSweepAABB(SDL_FRect moving, Vec2 delta, SDL_FRect target,
+                        CollisionHit *hit);
+void CollisionMoveAndSlide(CollisionMover *mover, SDL_FRect *obstacles,
+                           u32 obstacleCount);
+SDL_FRect CollisionGetSweptBounds(SDL_FRect box, Vec2 delta);
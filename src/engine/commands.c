@@ -0,0 +1,184 @@
+#include "engine/commands.h"
+
+void EcsCommandBufferInit(Arena *arena, EcsCommandBuffer *buffer, EcsWorld *world, u32 capacity, usize dataCapacity) {
+    buffer->arena = arena;
+    buffer->world = world;
+    buffer->commands = ArenaPushArray(arena, capacity, EcsCommand);
+    buffer->count = 0;
+    buffer->capacity = capacity;
+    buffer->spawnCount = 0;
+    buffer->spawned = ArenaPushArray(arena, capacity, EcsEntity);
+    buffer->data = ArenaPushArray(arena, dataCapacity, u8);
+    buffer->dataSize = 0;
+    buffer->dataCapacity = dataCapacity;
+}
+
+void EcsCommandBufferClear(EcsCommandBuffer *buffer) {
+    buffer->count = 0;
+    buffer->spawnCount = 0;
+    buffer->dataSize = 0;
+}
+
+static EcsCommand *EcsCommandPush(EcsCommandBuffer *buffer, EcsCommandType type, EcsEntity entity) {
+    // NOTE(SeedyROM): The old arrays are left behind in the arena, this should
+    // only happen for the odd huge tick like loading a level
+    if (buffer->count == buffer->capacity) {
+        u32 capacity = buffer->capacity * 2;
+        EcsCommand *commands = ArenaPushArray(buffer->arena, capacity, EcsCommand);
+        memcpy(commands, buffer->commands, buffer->count * sizeof(EcsCommand));
+        buffer->commands = commands;
+        buffer->spawned = ArenaPushArray(buffer->arena, capacity, EcsEntity);
+        buffer->capacity = capacity;
+    }
+
+    EcsCommand *command = &buffer->commands[buffer->count];
+    command->type = type;
+    command->entity = entity;
+    command->mask = 0;
+    command->id = 0;
+    command->sequence = buffer->count;
+    command->data = NULL;
+    buffer->count++;
+
+    return command;
+}
+
+EcsEntity EcsCommandSpawn(EcsCommandBuffer *buffer, EcsComponentMask mask) {
+    EcsEntity pending = {buffer->spawnCount++, 0};
+    EcsCommand *command = EcsCommandPush(buffer, EcsCommandType_Spawn, pending);
+    command->mask = mask;
+
+    return pending;
+}
+
+void EcsCommandDestroy(EcsCommandBuffer *buffer, EcsEntity entity) {
+    EcsCommandPush(buffer, EcsCommandType_Destroy, entity);
+}
+
+void EcsCommandAdd(EcsCommandBuffer *buffer, EcsEntity entity, EcsComponentId id) {
+    EcsCommand *command = EcsCommandPush(buffer, EcsCommandType_Add, entity);
+    command->id = id;
+}
+
+void EcsCommandRemove(EcsCommandBuffer *buffer, EcsEntity entity, EcsComponentId id) {
+    EcsCommand *command = EcsCommandPush(buffer, EcsCommandType_Remove, entity);
+    command->id = id;
+}
+
+void EcsCommandSet(EcsCommandBuffer *buffer, EcsEntity entity, EcsComponentId id, const void *data) {
+    usize size = buffer->world->componentSizes[id];
+    usize offset = (buffer->dataSize + 15) & ~(usize)15;
+    if (offset + size > buffer->dataCapacity) {
+        // Recorded values keep pointing at the old block, so just start a new one
+        buffer->dataCapacity = MAX(buffer->dataCapacity, size);
+        buffer->data = ArenaPushArray(buffer->arena, buffer->dataCapacity, u8);
+        offset = 0;
+    }
+
+    EcsCommand *command = EcsCommandPush(buffer, EcsCommandType_Set, entity);
+    command->id = id;
+    command->data = buffer->data + offset;
+    memcpy(command->data, data, size);
+    buffer->dataSize = offset + size;
+}
+
+static int EcsCommandCompare(const void *a, const void *b) {
+    const EcsCommand *commandA = a;
+    const EcsCommand *commandB = b;
+
+    if (commandA->entity.index != commandB->entity.index) {
+        return commandA->entity.index < commandB->entity.index ? -1 : 1;
+    }
+    if (commandA->entity.generation != commandB->entity.generation) {
+        return commandA->entity.generation < commandB->entity.generation ? -1 : 1;
+    }
+    if (commandA->sequence != commandB->sequence) {
+        return commandA->sequence < commandB->sequence ? -1 : 1;
+    }
+
+    return 0;
+}
+
+void EcsCommandBufferApply(EcsCommandBuffer *buffer) {
+    EcsWorld *world = buffer->world;
+
+    // Spawns go first so everything else can point at real entities
+    for (u32 i = 0; i < buffer->count; i++) {
+        EcsCommand *command = &buffer->commands[i];
+        if (command->type == EcsCommandType_Spawn) {
+            buffer->spawned[command->entity.index] = EcsSpawn(world, command->mask);
+        }
+    }
+
+    // Swap pending entities for the spawned ones and drop the spawns
+    u32 count = 0;
+    for (u32 i = 0; i < buffer->count; i++) {
+        EcsCommand command = buffer->commands[i];
+        if (command.type == EcsCommandType_Spawn) {
+            continue;
+        }
+
+        if (command.entity.generation == 0 && command.entity.index < buffer->spawnCount) {
+            command.entity = buffer->spawned[command.entity.index];
+        }
+        buffer->commands[count++] = command;
+    }
+
+    // Group by entity so each one moves archetype at most once. A stale handle and the live
+    // entity that reused its slot only differ by generation, so they end up in separate groups
+    qsort(buffer->commands, count, sizeof(EcsCommand), EcsCommandCompare);
+
+    u32 start = 0;
+    while (start < count) {
+        EcsEntity entity = buffer->commands[start].entity;
+        u32 end = start;
+        while (end < count && buffer->commands[end].entity.index == entity.index &&
+               buffer->commands[end].entity.generation == entity.generation) {
+            end++;
+        }
+
+        if (!EcsIsAlive(world, entity)) {
+            start = end;
+            continue;
+        }
+
+        // Work out where the entity ends up
+        EcsComponentMask mask = EcsGetMask(world, entity);
+        bool destroy = false;
+        for (u32 i = start; i < end; i++) {
+            EcsCommand *command = &buffer->commands[i];
+            if (command->type == EcsCommandType_Destroy) {
+                destroy = true;
+            } else if (command->type == EcsCommandType_Add) {
+                mask |= EcsComponentBit(command->id);
+            } else if (command->type == EcsCommandType_Remove) {
+                mask &= ~EcsComponentBit(command->id);
+            }
+        }
+
+        if (destroy) {
+            EcsDestroy(world, entity);
+            start = end;
+            continue;
+        }
+
+        EcsSetMask(world, entity, mask);
+
+        // Then write the values, the last set wins
+        for (u32 i = start; i < end; i++) {
+            EcsCommand *command = &buffer->commands[i];
+            if (command->type != EcsCommandType_Set) {
+                continue;
+            }
+
+            void *component = EcsGet(world, entity, command->id);
+            if (component != NULL) {
+                memcpy(component, command->data, world->componentSizes[command->id]);
+            }
+        }
+
+        start = end;
+    }
+
+    EcsCommandBufferClear(buffer);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine/arena.h"
+#include "engine/ecs.h"
+#include "engine/util.h"
+
+typedef enum EcsCommandType {
+  EcsCommandType_Spawn,
+  EcsCommandType_Destroy,
+  EcsCommandType_Add,
+  EcsCommandType_Remove,
+  EcsCommandType_Set,
+} EcsCommandType;
+
+typedef struct EcsCommand {
+  EcsCommandType type;
+  EcsEntity entity;
+  // The mask for spawns, the component for everything else
+  EcsComponentMask mask;
+  EcsComponentId id;
+  // Recording order, keeps changes to one entity in order after sorting
+  u32 sequence;
+  void *data;
+} EcsCommand;
+
+// Structural changes recorded while systems iterate, applied at a sync point.
+// Spawns hand back a pending entity (generation 0) that the other commands in
+// the same buffer can target, it only becomes real when the buffer is applied.
+// The buffer grows out of its arena when a tick records more than it expected.
+typedef struct EcsCommandBuffer {
+  Arena *arena;
+  EcsWorld *world;
+  EcsCommand *commands;
+  u32 count;
+  u32 capacity;
+  u32 spawnCount;
+  EcsEntity *spawned;
+  u8 *data;
+  usize dataSize;
+  usize dataCapacity;
+} EcsCommandBuffer;
+
+void EcsCommandBufferInit(Arena *arena, EcsCommandBuffer *buffer,
+                          EcsWorld *world, u32 capacity, usize dataCapacity);
+void EcsCommandBufferClear(EcsCommandBuffer *buffer);
+void EcsCommandBufferApply(EcsCommandBuffer *buffer);
+
+EcsEntity EcsCommandSpawn(EcsCommandBuffer *buffer, EcsComponentMask mask);
+void EcsCommandDestroy(EcsCommandBuffer *buffer, EcsEntity entity);
+void EcsCommandAdd(EcsCommandBuffer *buffer, EcsEntity entity,
+                   EcsComponentId id);
+void EcsCommandRemove(EcsCommandBuffer *buffer, EcsEntity entity,
+                      EcsComponentId id);
+void EcsCommandSet(EcsCommandBuffer *buffer, EcsEntity entity,
+                   EcsComponentId id, const void *data);
+
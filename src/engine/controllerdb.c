@@ -0,0 +1,136 @@
+#include "engine/controllerdb.h"
+
+int ControllerDbLoad(ControllerDb *db, const char *path) {
+    db->base = NULL;
+    db->size = 0;
+
+    int file = open(path, O_RDONLY);
+    if (file < 0) {
+        fprintf(stderr, "Failed to open controller mappings: %s\n", path);
+        return 1;
+    }
+
+    struct stat info;
+    if (fstat(file, &info) != 0 || (usize)info.st_size < sizeof(ControllerDbHeader)) {
+        fprintf(stderr, "Not controller mappings: %s\n", path);
+        close(file);
+        return 1;
+    }
+
+    db->size = info.st_size;
+    db->base = mmap(NULL, db->size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (db->base == MAP_FAILED) {
+        fprintf(stderr, "Failed to map controller mappings: %s\n", path);
+        db->base = NULL;
+        return 1;
+    }
+
+    ControllerDbHeader *header = db->base;
+    if (memcmp(header->magic, CONTROLLER_DB_MAGIC, sizeof(CONTROLLER_DB_MAGIC)) != 0 || header->version != ControllerDbVersion ||
+        header->fileSize != db->size) {
+        fprintf(stderr, "Not controller mappings we can read: %s\n", path);
+        ControllerDbUnload(db);
+        return 1;
+    }
+
+    // Both sections have to be in the file, and the last mapping has to end
+    usize entriesSize = (usize)header->entryCount * sizeof(ControllerDbEntry);
+    if (header->entriesOffset > db->size || entriesSize > db->size - header->entriesOffset ||
+        header->mappingsOffset > db->size || header->mappingsSize > db->size - header->mappingsOffset ||
+        (header->mappingsSize > 0 && ((char *)db->base)[header->mappingsOffset + header->mappingsSize - 1] != '\0') ||
+        memchr(header->platform, '\0', CONTROLLER_DB_PLATFORM_LENGTH) == NULL) {
+        fprintf(stderr, "Controller mappings are truncated: %s\n", path);
+        ControllerDbUnload(db);
+        return 1;
+    }
+
+    u8 *base = db->base;
+    db->header = header;
+    db->entries = (ControllerDbEntry *)(base + header->entriesOffset);
+    db->mappings = (char *)(base + header->mappingsOffset);
+
+    for (u32 i = 0; i < header->entryCount; i++) {
+        ControllerDbEntry *entry = &db->entries[i];
+        if (entry->mappingOffset >= header->mappingsSize || entry->mappingLength >= header->mappingsSize - entry->mappingOffset) {
+            fprintf(stderr, "Controller mappings have a bad entry: %s\n", path);
+            ControllerDbUnload(db);
+            return 1;
+        }
+    }
+
+    // Built for somewhere else, everything would look up fine and then not work
+    if (strcmp(header->platform, SDL_GetPlatform()) != 0) {
+        printf("Controller mappings are for %s, not %s\n", header->platform, SDL_GetPlatform());
+    }
+
+    return 0;
+}
+
+static ControllerDbEntry *ControllerDbSearch(ControllerDb *db, u8 *guid) {
+    u32 low = 0;
+    u32 high = db->header->entryCount;
+    while (low < high) {
+        u32 middle = low + (high - low) / 2;
+        int order = memcmp(db->entries[middle].guid, guid, sizeof(db->entries[middle].guid));
+        if (order == 0) {
+            return &db->entries[middle];
+        }
+        if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return NULL;
+}
+
+const char *ControllerDbFind(ControllerDb *db, SDL_JoystickGUID guid) {
+    if (db->base == NULL) {
+        return NULL;
+    }
+
+    ControllerDbEntry *entry = ControllerDbSearch(db, guid.data);
+
+    // NOTE(SeedyROM): Newer SDLs put a CRC of the name in bytes 2-3 of device GUIDs, the
+    // mappings are written without one. SDL matches them the same way.
+    if (entry == NULL) {
+        guid.data[2] = 0;
+        guid.data[3] = 0;
+        entry = ControllerDbSearch(db, guid.data);
+    }
+
+    // And plenty of mappings don't care about the version either
+    if (entry == NULL) {
+        guid.data[12] = 0;
+        guid.data[13] = 0;
+        entry = ControllerDbSearch(db, guid.data);
+    }
+
+    return entry != NULL ? db->mappings + entry->mappingOffset : NULL;
+}
+
+int ControllerDbRegister(ControllerDb *db, int deviceIndex) {
+    const char *mapping = ControllerDbFind(db, SDL_JoystickGetDeviceGUID(deviceIndex));
+    if (mapping == NULL) {
+        // SDL still knows plenty of controllers without a mapping from us
+        return 0;
+    }
+
+    if (SDL_GameControllerAddMapping(mapping) == -1) {
+        fprintf(stderr, "SDL_GameControllerAddMapping Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    return 0;
+}
+
+void ControllerDbUnload(ControllerDb *db) {
+    if (db->base != NULL) {
+        munmap(db->base, db->size);
+    }
+
+    db->base = NULL;
+    db->size = 0;
+}
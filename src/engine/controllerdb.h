@@ -0,0 +1,58 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "engine/util.h"
+
+// Controller mappings made by tools/controllerdbc.c from
+// assets/gamecontrollerdb.txt, only the ones for one platform.
+//
+// The header, then the entries sorted by GUID so a device can be looked up
+// with a binary search, then every mapping line NUL terminated, exactly how
+// SDL_GameControllerAddMapping wants it. Mapping a controller in only costs
+// a lookup and parsing its one line, rather than SDL parsing all of them up
+// front.
+
+#define CONTROLLER_DB_MAGIC "CAPYPAD"
+#define CONTROLLER_DB_PLATFORM_LENGTH 32
+
+static const u32 ControllerDbVersion = 1;
+
+typedef struct ControllerDbHeader {
+  char magic[8];
+  u32 version;
+  u32 fileSize;
+  // What SDL_GetPlatform says on the platform these are for
+  char platform[CONTROLLER_DB_PLATFORM_LENGTH];
+  u32 entryCount;
+  u32 entriesOffset;
+  u32 mappingsOffset;
+  u32 mappingsSize;
+} ControllerDbHeader;
+
+typedef struct ControllerDbEntry {
+  u8 guid[16];
+  // Relative to the mappings section, length doesn't count the NUL
+  u32 mappingOffset;
+  u32 mappingLength;
+} ControllerDbEntry;
+
+// A mapped database, every pointer here points into the file
+typedef struct ControllerDb {
+  void *base;
+  usize size;
+  ControllerDbHeader *header;
+  ControllerDbEntry *entries;
+  char *mappings;
+} ControllerDb;
+
+int ControllerDbLoad(ControllerDb *db, const char *path);
+const char *ControllerDbFind(ControllerDb *db, SDL_JoystickGUID guid);
+int ControllerDbRegister(ControllerDb *db, int deviceIndex);
+void ControllerDbUnload(ControllerDb *db);
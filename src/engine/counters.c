@@ -0,0 +1,186 @@
+#include "engine/counters.h"
+
+static Counters *counters = NULL;
+
+void CountersInit(Arena *arena) {
+    counters = ArenaPushStruct(arena, Counters);
+    memset(counters, 0, sizeof(Counters));
+    counters->samples = ArenaPushArray(arena, COUNTERS_RING_SIZE, CounterSample);
+    atomic_init(&counters->head, 0);
+    atomic_init(&counters->tail, 0);
+    atomic_init(&counters->running, false);
+
+    for (u32 i = 0; i < COUNTERS_MAX; i++) {
+        atomic_init(&counters->counters[i].value, 0);
+    }
+
+    CountersRegister(EngineCounter_DrawCalls, "draw_calls", CounterKind_Counter);
+}
+
+void CountersRegister(CounterId id, const char *name, CounterKind kind) {
+    if (id >= COUNTERS_MAX) {
+        printf("CountersRegister: counter id out of bounds\n");
+        exit(EXIT_FAILURE);
+    }
+
+    counters->counters[id].name = name;
+    counters->counters[id].kind = kind;
+    counters->count = MAX(counters->count, id + 1);
+}
+
+void CountersAdd(CounterId id, i64 amount) {
+    if (counters != NULL) {
+        atomic_fetch_add_explicit(&counters->counters[id].value, amount, memory_order_relaxed);
+    }
+}
+
+void CountersSet(CounterId id, i64 value) {
+    if (counters != NULL) {
+        atomic_store_explicit(&counters->counters[id].value, value, memory_order_relaxed);
+    }
+}
+
+void CountersSample(u64 frame) {
+    if (counters == NULL) {
+        return;
+    }
+
+    // Take the values either way so per-frame counters don't pile up
+    CounterSample sample;
+    sample.frame = frame;
+    for (u32 i = 0; i < counters->count; i++) {
+        Counter *counter = &counters->counters[i];
+        if (counter->kind == CounterKind_Counter) {
+            sample.values[i] = atomic_exchange_explicit(&counter->value, 0, memory_order_relaxed);
+        } else {
+            sample.values[i] = atomic_load_explicit(&counter->value, memory_order_relaxed);
+        }
+    }
+
+    if (!atomic_load_explicit(&counters->running, memory_order_relaxed)) {
+        return;
+    }
+
+    // NOTE(SeedyROM): Never wait on the writer, if it's fallen behind the sample is lost
+    u64 head = atomic_load_explicit(&counters->head, memory_order_relaxed);
+    u64 tail = atomic_load_explicit(&counters->tail, memory_order_acquire);
+    if (head - tail >= COUNTERS_RING_SIZE) {
+        counters->dropped++;
+        return;
+    }
+
+    counters->samples[head & COUNTERS_RING_MASK] = sample;
+    atomic_store_explicit(&counters->head, head + 1, memory_order_release);
+
+    // Wake the writer every so often rather than every frame
+    if ((head & 63) == 63) {
+        SDL_SemPost(counters->wake);
+    }
+}
+
+static void CountersWriteHeader(void) {
+    if (!counters->csv) {
+        return;
+    }
+
+    fprintf(counters->file, "frame");
+    for (u32 i = 0; i < counters->count; i++) {
+        if (counters->counters[i].name != NULL) {
+            fprintf(counters->file, ",%s", counters->counters[i].name);
+        }
+    }
+    fprintf(counters->file, "\n");
+}
+
+static void CountersWriteSample(CounterSample *sample) {
+    FILE *file = counters->file;
+    if (counters->csv) {
+        fprintf(file, "%llu", (unsigned long long)sample->frame);
+        for (u32 i = 0; i < counters->count; i++) {
+            if (counters->counters[i].name != NULL) {
+                fprintf(file, ",%lld", (long long)sample->values[i]);
+            }
+        }
+        fprintf(file, "\n");
+    } else {
+        fprintf(file, "{\"frame\":%llu", (unsigned long long)sample->frame);
+        for (u32 i = 0; i < counters->count; i++) {
+            if (counters->counters[i].name != NULL) {
+                fprintf(file, ",\"%s\":%lld", counters->counters[i].name, (long long)sample->values[i]);
+            }
+        }
+        fprintf(file, "}\n");
+    }
+}
+
+static void CountersDrain(void) {
+    u64 tail = atomic_load_explicit(&counters->tail, memory_order_relaxed);
+    u64 head = atomic_load_explicit(&counters->head, memory_order_acquire);
+    for (; tail < head; tail++) {
+        CountersWriteSample(&counters->samples[tail & COUNTERS_RING_MASK]);
+        atomic_store_explicit(&counters->tail, tail + 1, memory_order_release);
+    }
+    fflush(counters->file);
+}
+
+static int CountersWriterThread(void *data) {
+    (void)data;
+    while (atomic_load_explicit(&counters->running, memory_order_acquire)) {
+        SDL_SemWaitTimeout(counters->wake, 250);
+        CountersDrain();
+    }
+
+    // Whatever came in while we were shutting down
+    CountersDrain();
+    return 0;
+}
+
+// Writes CSV if the path ends in .csv, JSON lines otherwise
+int CountersStartWriter(const char *path) {
+    counters->file = fopen(path, "wb");
+    if (counters->file == NULL) {
+        fprintf(stderr, "Failed to open counters file: %s\n", path);
+        return 1;
+    }
+
+    usize length = strlen(path);
+    counters->csv = length >= 4 && strcmp(path + length - 4, ".csv") == 0;
+    CountersWriteHeader();
+
+    counters->wake = SDL_CreateSemaphore(0);
+    if (counters->wake == NULL) {
+        fprintf(stderr, "SDL_CreateSemaphore Error: %s\n", SDL_GetError());
+        fclose(counters->file);
+        return 1;
+    }
+
+    atomic_store(&counters->running, true);
+    counters->writer = SDL_CreateThread(CountersWriterThread, "capy-counters", NULL);
+    if (counters->writer == NULL) {
+        fprintf(stderr, "SDL_CreateThread Error: %s\n", SDL_GetError());
+        atomic_store(&counters->running, false);
+        SDL_DestroySemaphore(counters->wake);
+        fclose(counters->file);
+        return 1;
+    }
+
+    return 0;
+}
+
+void CountersStopWriter(void) {
+    if (counters == NULL || counters->writer == NULL) {
+        return;
+    }
+
+    atomic_store_explicit(&counters->running, false, memory_order_release);
+    SDL_SemPost(counters->wake);
+    SDL_WaitThread(counters->writer, NULL);
+    counters->writer = NULL;
+
+    if (counters->dropped > 0) {
+        printf("Counters dropped %llu samples\n", (unsigned long long)counters->dropped);
+    }
+
+    SDL_DestroySemaphore(counters->wake);
+    fclose(counters->file);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "engine/arena.h"
+#include "engine/util.h"
+
+#define COUNTERS_MAX 64
+
+// Samples buffered for the writer thread, a power of two
+#define COUNTERS_RING_SIZE 1024
+#define COUNTERS_RING_MASK (COUNTERS_RING_SIZE - 1)
+
+typedef u32 CounterId;
+
+typedef enum CounterKind {
+  // Summed over a frame and reset when sampled
+  CounterKind_Counter = 0,
+  // Holds whatever was last set
+  CounterKind_Gauge = 1,
+} CounterKind;
+
+// The engine's own counters, games register theirs from EngineCounter_Count up
+typedef enum EngineCounter {
+  EngineCounter_DrawCalls = 0,
+  EngineCounter_Count,
+} EngineCounter;
+
+typedef struct Counter {
+  const char *name;
+  CounterKind kind;
+  atomic_llong value;
+} Counter;
+
+typedef struct CounterSample {
+  u64 frame;
+  i64 values[COUNTERS_MAX];
+} CounterSample;
+
+// Named counters bumped from anywhere, sampled once a frame on the main thread
+// and written out by a thread of their own so the frame never waits on disk.
+typedef struct Counters {
+  Counter counters[COUNTERS_MAX];
+  u32 count;
+
+  // Main thread writes samples at the head, the writer reads from the tail
+  CounterSample *samples;
+  atomic_ullong head;
+  atomic_ullong tail;
+  u64 dropped;
+
+  FILE *file;
+  bool csv;
+  atomic_bool running;
+  SDL_sem *wake;
+  SDL_Thread *writer;
+} Counters;
+
+void CountersInit(Arena *arena);
+void CountersRegister(CounterId id, const char *name, CounterKind kind);
+int CountersStartWriter(const char *path);
+void CountersStopWriter(void);
+
+void CountersAdd(CounterId id, i64 amount);
+void CountersSet(CounterId id, i64 value);
+void CountersSample(u64 frame);
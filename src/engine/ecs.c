@@ -0,0 +1,342 @@
+#include "engine/ecs.h"
+
+static inline EcsEntityRecord *EcsGetRecord(EcsWorld *world, u32 index) {
+    return &world->recordChunks[index >> ECS_CHUNK_SHIFT][index & ECS_CHUNK_MASK];
+}
+
+// Adds another chunk of records
+static void EcsGrowRecords(EcsWorld *world) {
+    if (world->recordChunkCount == world->recordChunkCapacity) {
+        // NOTE(SeedyROM): Only the table of chunks moves, records stay put
+        u32 chunkCapacity = MAX(world->recordChunkCapacity * 2, 4);
+        EcsEntityRecord **chunks = ArenaPushArray(world->arena, chunkCapacity, EcsEntityRecord *);
+        if (world->recordChunkCount > 0) {
+            memcpy(chunks, world->recordChunks, world->recordChunkCount * sizeof(EcsEntityRecord *));
+        }
+        world->recordChunks = chunks;
+        world->recordChunkCapacity = chunkCapacity;
+    }
+
+    EcsEntityRecord *records = ArenaPushArray(world->arena, ECS_CHUNK_SIZE, EcsEntityRecord);
+    world->recordChunks[world->recordChunkCount++] = records;
+
+    // Chain the new records in front of whatever is still free, EcsWorldInit grows
+    // several times before anything is taken
+    u32 first = world->entityCapacity;
+    for (u32 i = 0; i < ECS_CHUNK_SIZE; i++) {
+        records[i].row = first + i + 1;
+        records[i].generation = 1;
+        records[i].alive = false;
+    }
+    records[ECS_CHUNK_SIZE - 1].row = world->freeRecord;
+    world->freeRecord = first;
+    world->entityCapacity += ECS_CHUNK_SIZE;
+}
+
+void EcsWorldInit(Arena *arena, EcsWorld *world, u32 entityCapacity) {
+    memset(world, 0, sizeof(EcsWorld));
+    world->arena = arena;
+
+    // Reserve what was asked for, more records get added as needed
+    do {
+        EcsGrowRecords(world);
+    } while (world->entityCapacity < entityCapacity);
+}
+
+usize EcsWorldMemory(u32 entityCapacity, u32 archetypeCount, usize rowSize) {
+    // NOTE(SeedyROM): Chunks are never given back, so each archetype can end up holding every entity at
+    // once. The tables of chunks double from 4 and the old ones stay behind, all of them together are
+    // less than twice the last one, which is less than twice the chunk count plus 4.
+    usize chunkCount = MAX((entityCapacity + ECS_CHUNK_SIZE - 1) / ECS_CHUNK_SIZE, 1);
+    usize tableCount = 4 * chunkCount + 8;
+
+    usize records = chunkCount * ECS_CHUNK_SIZE * sizeof(EcsEntityRecord) + tableCount * sizeof(EcsEntityRecord *);
+    usize archetype = chunkCount * ECS_CHUNK_SIZE * (sizeof(EcsEntity) + rowSize) + tableCount * sizeof(EcsChunk);
+    return records + archetypeCount * archetype;
+}
+
+void EcsRegisterComponent(EcsWorld *world, EcsComponentId id, usize size) {
+    if (id >= ECS_MAX_COMPONENTS) {
+        printf("EcsRegisterComponent: component id out of bounds\n");
+        exit(EXIT_FAILURE);
+    }
+
+    world->componentSizes[id] = size;
+    world->registered |= EcsComponentBit(id);
+}
+
+static u32 EcsGetArchetype(EcsWorld *world, EcsComponentMask mask) {
+    for (u32 i = 0; i < world->archetypeCount; i++) {
+        if (world->archetypes[i].mask == mask) {
+            return i;
+        }
+    }
+
+    if ((mask & ~world->registered) != 0) {
+        printf("EcsGetArchetype: unregistered component\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (world->archetypeCount == ECS_MAX_ARCHETYPES) {
+        printf("EcsGetArchetype: too many archetypes\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // First time we've seen this combination, chunks get added on the first spawn
+    u32 index = world->archetypeCount++;
+    EcsArchetype *archetype = &world->archetypes[index];
+    memset(archetype, 0, sizeof(EcsArchetype));
+    archetype->mask = mask;
+
+    for (EcsComponentId id = 0; id < ECS_MAX_COMPONENTS; id++) {
+        if ((mask & EcsComponentBit(id)) && world->componentSizes[id] > 0) {
+            archetype->columnMask |= EcsComponentBit(id);
+        }
+    }
+
+    return index;
+}
+
+static void EcsArchetypeGrow(EcsWorld *world, EcsArchetype *archetype) {
+    if (archetype->chunkCount == archetype->chunkCapacity) {
+        u32 chunkCapacity = MAX(archetype->chunkCapacity * 2, 4);
+        EcsChunk *chunks = ArenaPushArray(world->arena, chunkCapacity, EcsChunk);
+        if (archetype->chunkCount > 0) {
+            memcpy(chunks, archetype->chunks, archetype->chunkCount * sizeof(EcsChunk));
+        }
+        archetype->chunks = chunks;
+        archetype->chunkCapacity = chunkCapacity;
+    }
+
+    EcsChunk *chunk = &archetype->chunks[archetype->chunkCount++];
+    memset(chunk, 0, sizeof(EcsChunk));
+    chunk->entities = ArenaPushArray(world->arena, ECS_CHUNK_SIZE, EcsEntity);
+    for (EcsComponentId id = 0; id < ECS_MAX_COMPONENTS; id++) {
+        if (archetype->columnMask & EcsComponentBit(id)) {
+            chunk->columns[id] = ArenaPushArray(world->arena, ECS_CHUNK_SIZE * world->componentSizes[id], u8);
+        }
+    }
+    archetype->capacity += ECS_CHUNK_SIZE;
+}
+
+static inline EcsChunk *EcsArchetypeChunk(EcsArchetype *archetype, u32 row) {
+    return &archetype->chunks[row >> ECS_CHUNK_SHIFT];
+}
+
+static inline void *EcsColumnRow(EcsWorld *world, EcsArchetype *archetype, EcsComponentId id, u32 row) {
+    return (u8 *)EcsArchetypeChunk(archetype, row)->columns[id] + (row & ECS_CHUNK_MASK) * world->componentSizes[id];
+}
+
+// Appends a zeroed row for the entity and returns it
+static u32 EcsArchetypePushRow(EcsWorld *world, EcsArchetype *archetype, EcsEntity entity) {
+    if (archetype->count == archetype->capacity) {
+        EcsArchetypeGrow(world, archetype);
+    }
+
+    u32 row = archetype->count++;
+    EcsArchetypeChunk(archetype, row)->entities[row & ECS_CHUNK_MASK] = entity;
+    for (EcsComponentId id = 0; id < ECS_MAX_COMPONENTS; id++) {
+        if (archetype->columnMask & EcsComponentBit(id)) {
+            memset(EcsColumnRow(world, archetype, id, row), 0, world->componentSizes[id]);
+        }
+    }
+
+    return row;
+}
+
+// Fills the hole with the last row and fixes up the moved entity's record
+static void EcsArchetypeRemoveRow(EcsWorld *world, EcsArchetype *archetype, u32 row) {
+    u32 last = archetype->count - 1;
+    if (row != last) {
+        for (EcsComponentId id = 0; id < ECS_MAX_COMPONENTS; id++) {
+            if (archetype->columnMask & EcsComponentBit(id)) {
+                memcpy(EcsColumnRow(world, archetype, id, row), EcsColumnRow(world, archetype, id, last), world->componentSizes[id]);
+            }
+        }
+
+        EcsEntity moved = EcsArchetypeChunk(archetype, last)->entities[last & ECS_CHUNK_MASK];
+        EcsArchetypeChunk(archetype, row)->entities[row & ECS_CHUNK_MASK] = moved;
+        EcsGetRecord(world, moved.index)->row = row;
+    }
+    archetype->count--;
+}
+
+EcsEntity EcsSpawn(EcsWorld *world, EcsComponentMask mask) {
+    if (world->entityCount == world->entityCapacity) {
+        EcsGrowRecords(world);
+    }
+
+    // Take a record off the free list
+    u32 index = world->freeRecord;
+    EcsEntityRecord *record = EcsGetRecord(world, index);
+    world->freeRecord = record->row;
+
+    EcsEntity entity = {index, record->generation};
+    record->archetype = EcsGetArchetype(world, mask);
+    record->row = EcsArchetypePushRow(world, &world->archetypes[record->archetype], entity);
+    record->alive = true;
+    world->entityCount++;
+
+    return entity;
+}
+
+bool EcsIsAlive(EcsWorld *world, EcsEntity entity) {
+    if (entity.index >= world->entityCapacity) {
+        return false;
+    }
+
+    EcsEntityRecord *record = EcsGetRecord(world, entity.index);
+    return record->alive && record->generation == entity.generation;
+}
+
+void EcsDestroy(EcsWorld *world, EcsEntity entity) {
+    if (!EcsIsAlive(world, entity)) {
+        return;
+    }
+
+    EcsEntityRecord *record = EcsGetRecord(world, entity.index);
+    EcsArchetypeRemoveRow(world, &world->archetypes[record->archetype], record->row);
+
+    // Invalidate old ids and free the record, skipping 0 so null never resolves
+    record->alive = false;
+    record->generation++;
+    if (record->generation == 0) {
+        record->generation = 1;
+    }
+    record->row = world->freeRecord;
+    world->freeRecord = entity.index;
+    world->entityCount--;
+}
+
+void *EcsGet(EcsWorld *world, EcsEntity entity, EcsComponentId id) {
+    if (!EcsIsAlive(world, entity)) {
+        return NULL;
+    }
+
+    EcsEntityRecord *record = EcsGetRecord(world, entity.index);
+    EcsArchetype *archetype = &world->archetypes[record->archetype];
+    if ((archetype->columnMask & EcsComponentBit(id)) == 0) {
+        return NULL;
+    }
+
+    return EcsColumnRow(world, archetype, id, record->row);
+}
+
+bool EcsHas(EcsWorld *world, EcsEntity entity, EcsComponentId id) {
+    if (!EcsIsAlive(world, entity)) {
+        return false;
+    }
+
+    EcsEntityRecord *record = EcsGetRecord(world, entity.index);
+    return (world->archetypes[record->archetype].mask & EcsComponentBit(id)) != 0;
+}
+
+EcsComponentMask EcsGetMask(EcsWorld *world, EcsEntity entity) {
+    if (!EcsIsAlive(world, entity)) {
+        return 0;
+    }
+
+    return world->archetypes[EcsGetRecord(world, entity.index)->archetype].mask;
+}
+
+// Moves an entity to the archetype for its new component set, keeping shared components
+static void EcsMove(EcsWorld *world, EcsEntity entity, EcsComponentMask mask) {
+    EcsEntityRecord *record = EcsGetRecord(world, entity.index);
+    u32 targetIndex = EcsGetArchetype(world, mask);
+    if (targetIndex == record->archetype) {
+        return;
+    }
+
+    EcsArchetype *source = &world->archetypes[record->archetype];
+    EcsArchetype *target = &world->archetypes[targetIndex];
+
+    u32 sourceRow = record->row;
+    u32 targetRow = EcsArchetypePushRow(world, target, entity);
+    for (EcsComponentId id = 0; id < ECS_MAX_COMPONENTS; id++) {
+        if (source->columnMask & target->columnMask & EcsComponentBit(id)) {
+            memcpy(EcsColumnRow(world, target, id, targetRow), EcsColumnRow(world, source, id, sourceRow), world->componentSizes[id]);
+        }
+    }
+
+    EcsArchetypeRemoveRow(world, source, sourceRow);
+    record->archetype = targetIndex;
+    record->row = targetRow;
+}
+
+void EcsSetMask(EcsWorld *world, EcsEntity entity, EcsComponentMask mask) {
+    if (!EcsIsAlive(world, entity)) {
+        return;
+    }
+
+    EcsMove(world, entity, mask);
+}
+
+void EcsAdd(EcsWorld *world, EcsEntity entity, EcsComponentId id) {
+    if (!EcsIsAlive(world, entity)) {
+        return;
+    }
+
+    EcsComponentMask mask = world->archetypes[EcsGetRecord(world, entity.index)->archetype].mask;
+    EcsMove(world, entity, mask | EcsComponentBit(id));
+}
+
+void EcsRemove(EcsWorld *world, EcsEntity entity, EcsComponentId id) {
+    if (!EcsIsAlive(world, entity)) {
+        return;
+    }
+
+    EcsComponentMask mask = world->archetypes[EcsGetRecord(world, entity.index)->archetype].mask;
+    EcsMove(world, entity, mask & ~EcsComponentBit(id));
+}
+
+EcsQuery EcsQueryBegin(EcsWorld *world, EcsComponentMask mask) {
+    EcsQuery query = {
+        .world = world,
+        .mask = mask,
+        .next = 0,
+        .nextChunk = 0,
+        .archetype = NULL,
+        .chunk = NULL,
+        .count = 0};
+
+    return query;
+}
+
+bool EcsQueryNext(EcsQuery *query) {
+    EcsWorld *world = query->world;
+    for (;;) {
+        // Carry on through the chunks of the current archetype
+        EcsArchetype *archetype = query->archetype;
+        if (archetype != NULL && (query->nextChunk << ECS_CHUNK_SHIFT) < archetype->count) {
+            u32 first = query->nextChunk << ECS_CHUNK_SHIFT;
+            query->chunk = &archetype->chunks[query->nextChunk++];
+            query->count = MIN(archetype->count - first, ECS_CHUNK_SIZE);
+            return true;
+        }
+
+        // Then find the next archetype that matches
+        query->archetype = NULL;
+        while (query->next < world->archetypeCount) {
+            EcsArchetype *candidate = &world->archetypes[query->next++];
+            if ((candidate->mask & query->mask) == query->mask && candidate->count > 0) {
+                query->archetype = candidate;
+                query->nextChunk = 0;
+                break;
+            }
+        }
+
+        if (query->archetype == NULL) {
+            query->chunk = NULL;
+            query->count = 0;
+            return false;
+        }
+    }
+}
+
+void *EcsQueryColumn(EcsQuery *query, EcsComponentId id) {
+    return query->chunk->columns[id];
+}
+
+EcsEntity *EcsQueryEntities(EcsQuery *query) {
+    return query->chunk->entities;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "engine/arena.h"
+#include "engine/util.h"
+
+#define ECS_MAX_COMPONENTS 32
+#define ECS_MAX_ARCHETYPES 64
+
+// Rows per archetype chunk and records per record chunk
+#define ECS_CHUNK_SHIFT 10
+#define ECS_CHUNK_SIZE (1u << ECS_CHUNK_SHIFT)
+#define ECS_CHUNK_MASK (ECS_CHUNK_SIZE - 1)
+
+typedef u32 EcsComponentId;
+typedef u32 EcsComponentMask;
+
+#define EcsComponentBit(id) (1u << (id))
+
+// Generational entity id, a zeroed entity never resolves
+typedef struct EcsEntity {
+  u32 index;
+  u32 generation;
+} EcsEntity;
+
+static const EcsEntity EcsEntityNull = {0, 0};
+
+// A fixed block of rows, each component in its own tightly packed column
+typedef struct EcsChunk {
+  EcsEntity *entities;
+  void *columns[ECS_MAX_COMPONENTS];
+} EcsChunk;
+
+// Every entity with exactly the same set of components lives in one archetype.
+// Rows are packed across chunks that get added as the archetype grows, so
+// nothing is copied when it does.
+typedef struct EcsArchetype {
+  EcsComponentMask mask;
+  // Components that actually have data, tags don't get a column
+  EcsComponentMask columnMask;
+  u32 count;
+  u32 capacity;
+  EcsChunk *chunks;
+  u32 chunkCount;
+  u32 chunkCapacity;
+} EcsArchetype;
+
+typedef struct EcsEntityRecord {
+  u32 archetype;
+  // Row in the archetype when alive, next free record otherwise
+  u32 row;
+  u32 generation;
+  bool alive;
+} EcsEntityRecord;
+
+typedef struct EcsWorld {
+  Arena *arena;
+  usize componentSizes[ECS_MAX_COMPONENTS];
+  EcsComponentMask registered;
+  EcsArchetype archetypes[ECS_MAX_ARCHETYPES];
+  u32 archetypeCount;
+  EcsEntityRecord **recordChunks;
+  u32 recordChunkCount;
+  u32 recordChunkCapacity;
+  u32 entityCapacity;
+  u32 entityCount;
+  u32 freeRecord;
+} EcsWorld;
+
+// Walks every chunk of every archetype that has at least the queried
+// components, count is the number of rows in the current chunk
+typedef struct EcsQuery {
+  EcsWorld *world;
+  EcsComponentMask mask;
+  u32 next;
+  u32 nextChunk;
+  EcsArchetype *archetype;
+  EcsChunk *chunk;
+  u32 count;
+} EcsQuery;
+
+void EcsWorldInit(Arena *arena, EcsWorld *world, u32 entityCapacity);
+// The most a world can take from its arena keeping up to entityCapacity entities alive,
+// spread over at most archetypeCount archetypes with rows no wider than rowSize
+usize EcsWorldMemory(u32 entityCapacity, u32 archetypeCount, usize rowSize);
+void EcsRegisterComponent(EcsWorld *world, EcsComponentId id, usize size);
+
+EcsEntity EcsSpawn(EcsWorld *world, EcsComponentMask mask);
+void EcsDestroy(EcsWorld *world, EcsEntity entity);
+bool EcsIsAlive(EcsWorld *world, EcsEntity entity);
+void *EcsGet(EcsWorld *world, EcsEntity entity, EcsComponentId id);
+bool EcsHas(EcsWorld *world, EcsEntity entity, EcsComponentId id);
+EcsComponentMask EcsGetMask(EcsWorld *world, EcsEntity entity);
+void EcsSetMask(EcsWorld *world, EcsEntity entity, EcsComponentMask mask);
+void EcsAdd(EcsWorld *world, EcsEntity entity, EcsComponentId id);
+void EcsRemove(EcsWorld *world, EcsEntity entity, EcsComponentId id);
+
+EcsQuery EcsQueryBegin(EcsWorld *world, EcsComponentMask mask);
+bool EcsQueryNext(EcsQuery *query);
+void *EcsQueryColumn(EcsQuery *query, EcsComponentId id);
+EcsEntity *EcsQueryEntities(EcsQuery *query);
+
+#define EcsGetComponent(world, entity, type, id)                               \
+  ((type *)EcsGet(world, entity, id))
+#define EcsQueryColumnOf(query, type, id) ((type *)EcsQueryColumn(query, id))
@@ -1,8 +1,25 @@
 #pragma once
 
+#include "engine/aabb.h"
 #include "engine/arena.h"
 #include "engine/aseprite.h"
-#include "engine/entity.h"
+#include "engine/broadphase.h"
+#include "engine/capture.h"
+#include "engine/clock.h"
+#include "engine/collision.h"
+#include "engine/commands.h"
+#include "engine/controllerdb.h"
+#include "engine/counters.h"
+#include "engine/ecs.h"
 #include "engine/fs.h"
 #include "engine/gfx.h"
+#include "engine/input.h"
+#include "engine/job.h"
+#include "engine/level.h"
+#include "engine/mask.h"
+#include "engine/profile.h"
+#include "engine/rewind.h"
+#include "engine/stream.h"
+#include "engine/tilemap.h"
+#include "engine/triplebuffer.h"
 #include "engine/util.h"
@@ -2,6 +2,10 @@
 
 #include <glob.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #define STB_RECT_PACK_IMPLEMENTATION
 #include <stb_rectpack.h>
 
@@ -12,21 +16,103 @@ TextureAtlas *TextureAtlasCreate(Arena *arena) {
     atlas->arena = arena;
     atlas->indices = ARRAY_INIT_DEFINED(atlas->arena, TextureAtlasIndices, TextureAtlasIndex, 128);
     atlas->frames = ARRAY_INIT_DEFINED(atlas->arena, TextureAtlasFrames, TextureAtlasFrame, 128);
+    atlas->alphas = ARRAY_INIT_DEFINED(atlas->arena, TextureAtlasAlphas, TextureAtlasAlpha, 128);
+    atlas->masks = ARRAY_INIT_DEFINED(atlas->arena, TextureAtlasMasks, CollisionMask, 128);
     atlas->texture = NULL;
+    atlas->blendMode = SDL_BLENDMODE_BLEND;
+    atlas->currentBlendMode = SDL_BLENDMODE_BLEND;
+    atlas->premultiplied = false;
     atlas->width = 0;
     atlas->height = 0;
 
     return atlas;
 }
 
-int TextureAtlasLoadSprites(SDL_Renderer *renderer, TextureAtlas *atlas, String *path) {
+static TextureAtlasAlpha TextureAtlasClassifyFrame(u32 *pixels, u16 stride, SDL_Rect *rect) {
+    for (int y = rect->y; y < rect->y + rect->h; y++) {
+        for (int x = rect->x; x < rect->x + rect->w; x++) {
+            if ((pixels[y * stride + x] >> 24) != 255) {
+                return TextureAtlasAlpha_Translucent;
+            }
+        }
+    }
+
+    return TextureAtlasAlpha_Opaque;
+}
+
+// Multiplies the color channels by alpha, rounding exactly like x * a / 255
+void TextureAtlasPremultiplyPixels(u32 *pixels, usize count) {
+    usize i = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+    const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+
+    // 4 pixels at a time, widened to 16 bits per channel
+    for (; i + 4 <= count; i += 4) {
+        __m128i source = _mm_loadu_si128((__m128i *)(pixels + i));
+
+        __m128i low = _mm_unpacklo_epi8(source, zero);
+        __m128i high = _mm_unpackhi_epi8(source, zero);
+
+        // Broadcast each pixel's alpha to all 4 of its channels
+        __m128i lowAlpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(low, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i highAlpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(high, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+        low = _mm_add_epi16(_mm_mullo_epi16(low, lowAlpha), half);
+        high = _mm_add_epi16(_mm_mullo_epi16(high, highAlpha), half);
+        low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+        high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+
+        // Put the untouched alpha back
+        __m128i result = _mm_packus_epi16(low, high);
+        result = _mm_or_si128(_mm_andnot_si128(alphaMask, result), _mm_and_si128(alphaMask, source));
+        _mm_storeu_si128((__m128i *)(pixels + i), result);
+    }
+#endif
+
+    for (; i < count; i++) {
+        u32 pixel = pixels[i];
+        u32 alpha = pixel >> 24;
+        u32 result = pixel & 0xFF000000;
+        for (u32 shift = 0; shift < 24; shift += 8) {
+            u32 channel = ((pixel >> shift) & 0xFF) * alpha + 128;
+            result |= ((channel + (channel >> 8)) >> 8) << shift;
+        }
+        pixels[i] = result;
+    }
+}
+
+// Sprite assets memory
+typedef struct SpriteAssetPath {
+    String name;
+    String path;
+} SpriteAssetPath;
+
+typedef struct TextureAtlasDecode {
+    SpriteAssetPath *paths;
+    AsepriteFile **files;
+    // One scratch arena per worker, arenas aren't thread safe
+    Arena **arenas;
+} TextureAtlasDecode;
+
+static void TextureAtlasDecodeJob(void *data, u32 start, u32 end) {
+    TextureAtlasDecode *decode = data;
+    u32 worker = JobSystemWorkerIndex();
+    Arena *arena = decode->arenas[worker == JobWorkerNone ? 0 : worker];
+
+    for (u32 i = start; i < end; i++) {
+        printf("Loading sprite asset: %s = %s\n", decode->paths[i].name.ptr, decode->paths[i].path.ptr);
+        ProfileBlock("AsepriteLoad") {
+            decode->files[i] = AsepriteLoad(arena, &decode->paths[i].path);
+        }
+    }
+}
+
+int TextureAtlasLoadSprites(SDL_Renderer *renderer, JobSystem *jobs, TextureAtlas *atlas, String *path) {
     Arena *scratch = ArenaAlloc(128 * Megabyte);
     tempMemoryBlock(scratch) {
-        // Sprite assets memory
-        typedef struct SpriteAssetPath {
-            String name;
-            String path;
-        } SpriteAssetPath;
         ARRAY(SpriteAssetPath, spriteAssetPaths);
 
         // Glob for sprite assets
@@ -60,20 +146,31 @@ int TextureAtlasLoadSprites(SDL_Renderer *renderer, TextureAtlas *atlas, String
             }
         }
 
-        // Load the sprite assets
-        ARRAY_ALLOC_RESERVED(scratch, AsepriteFile, sprites, spriteAssetPaths.len);
+        // Decode the sprite assets, spread over the workers when we have them
+        u32 workerCount = jobs != NULL ? jobs->workerCount : 1;
+        TextureAtlasDecode decode = {
+            .paths = spriteAssetPaths.ptr,
+            .files = ArenaPushArrayZero(scratch, spriteAssetPaths.len, AsepriteFile *),
+            .arenas = ArenaPushArray(scratch, workerCount, Arena *)};
+        for (u32 i = 0; i < workerCount; i++) {
+            decode.arenas[i] = ArenaAlloc(32 * Megabyte);
+        }
+
+        if (jobs != NULL) {
+            JobCounter decoded;
+            JobCounterInit(&decoded);
+            JobSystemParallelFor(jobs, spriteAssetPaths.len, 1, TextureAtlasDecodeJob, &decode, &decoded);
+            JobSystemWait(jobs, &decoded);
+        } else {
+            TextureAtlasDecodeJob(&decode, 0, spriteAssetPaths.len);
+        }
 
         // Allocate space for the sprite frames
         ARRAY_ALLOC(scratch, AsepriteAnimationFrame, spriteFrames, 128);
 
-        for (usize i = 0; i < sprites.len; i++) {
-            // Read the sprite asset file
-            String *spriteAssetPath = &spriteAssetPaths.ptr[i].path;
+        for (usize i = 0; i < spriteAssetPaths.len; i++) {
             String *spriteAssetName = &spriteAssetPaths.ptr[i].name;
-
-            printf("Loading sprite asset: %s = %s\n", spriteAssetName->ptr, spriteAssetPath->ptr);
-            AsepriteFile *sprite = &sprites.ptr[i];
-            sprite = AsepriteLoad(scratch, spriteAssetPath);
+            AsepriteFile *sprite = decode.files[i];
 
             // Add the sprite asset to the atlas index
             TextureAtlasIndex atlasIndex = {
@@ -148,14 +245,52 @@ int TextureAtlasLoadSprites(SDL_Renderer *renderer, TextureAtlas *atlas, String
             }
         }
 
-        // Create a texture from the atlas
-        atlas->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STATIC, atlas->width, atlas->height);
+        // Find the frames that don't need blending at all
+        for (usize i = 0; i < atlas->frames.len; i++) {
+            TextureAtlasAlpha alpha = TextureAtlasClassifyFrame(atlasPixels, atlas->width, &atlas->frames.ptr[i]);
+            ARRAY_PUSH(atlas->arena, atlas->alphas, TextureAtlasAlpha, alpha);
+        }
 
-        // Copy the atlas pixels into the texture
-        SDL_UpdateTexture(atlas->texture, NULL, atlasPixels, atlas->width * sizeof(u32));
+        // Build the collision masks while the alpha is still straight
+        for (usize i = 0; i < atlas->frames.len; i++) {
+            SDL_Rect *frame = &atlas->frames.ptr[i];
+            CollisionMask mask;
+            CollisionMaskBuild(atlas->arena, &mask, &atlasPixels[frame->y * atlas->width + frame->x], atlas->width, frame->w, frame->h);
+            ARRAY_PUSH(atlas->arena, atlas->masks, CollisionMask, mask);
+        }
+
+        // Without a renderer only the frames, alphas and masks are kept, enough to simulate
+        atlas->texture = NULL;
+        atlas->blendMode = SDL_BLENDMODE_BLEND;
+        atlas->currentBlendMode = SDL_BLENDMODE_BLEND;
+        atlas->premultiplied = false;
+        if (renderer != NULL) {
+            // Create a texture from the atlas
+            atlas->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STATIC, atlas->width, atlas->height);
+
+            // Use premultiplied alpha if the renderer can do custom blending, the software renderer can't
+            SDL_BlendMode premultipliedBlendMode = SDL_ComposeCustomBlendMode(
+                SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+                SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+            if (SDL_SetTextureBlendMode(atlas->texture, premultipliedBlendMode) == 0) {
+                TextureAtlasPremultiplyPixels(atlasPixels, atlas->width * atlas->height);
+                atlas->blendMode = premultipliedBlendMode;
+                atlas->premultiplied = true;
+            } else {
+                SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+                atlas->blendMode = SDL_BLENDMODE_BLEND;
+                atlas->premultiplied = false;
+            }
+            atlas->currentBlendMode = atlas->blendMode;
 
-        // Allow for alpha blending
-        SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+            // Copy the atlas pixels into the texture
+            SDL_UpdateTexture(atlas->texture, NULL, atlasPixels, atlas->width * sizeof(u32));
+        }
+
+        // The frame pixels lived in the decode arenas
+        for (u32 i = 0; i < workerCount; i++) {
+            ArenaFree(decode.arenas[i]);
+        }
     }
     ArenaFree(scratch);
 
@@ -188,7 +323,9 @@ TextureAtlasFrames TextureAtlasIndicesGetFrames(TextureAtlas *atlas, String *nam
 }
 
 void TextureAtlasFree(TextureAtlas *atlas) {
-    SDL_DestroyTexture(atlas->texture);
+    if (atlas->texture != NULL) {
+        SDL_DestroyTexture(atlas->texture);
+    }
 }
 
 void SpriteFromAtlas(Sprite *sprite, TextureAtlas *atlas, String *name) {
@@ -209,8 +346,25 @@ void SpriteChange(Sprite *sprite, String *name) {
     sprite->currentFrame = 0;
 }
 
+usize SpriteGetAtlasFrame(Sprite *sprite, u16 currentFrame) {
+    return (sprite->frames.ptr - sprite->atlas->frames.ptr) + currentFrame;
+}
+
+CollisionMask *SpriteGetMask(Sprite *sprite, u16 currentFrame) {
+    return &sprite->atlas->masks.ptr[SpriteGetAtlasFrame(sprite, currentFrame)];
+}
+
 void SpriteDrawFrame(Sprite *sprite, SDL_Renderer *renderer, u16 currentFrame) {
     SDL_Rect *frame = &sprite->frames.ptr[currentFrame];
+    TextureAtlas *atlas = sprite->atlas;
+
+    // Opaque frames skip blending entirely
+    TextureAtlasAlpha alpha = atlas->alphas.ptr[SpriteGetAtlasFrame(sprite, currentFrame)];
+    SDL_BlendMode blendMode = alpha == TextureAtlasAlpha_Opaque ? SDL_BLENDMODE_NONE : atlas->blendMode;
+    if (blendMode != atlas->currentBlendMode) {
+        SDL_SetTextureBlendMode(atlas->texture, blendMode);
+        atlas->currentBlendMode = blendMode;
+    }
 
     SDL_Rect destRect = {
         .x = sprite->pos.x,
@@ -231,7 +385,8 @@ void SpriteDrawFrame(Sprite *sprite, SDL_Renderer *renderer, u16 currentFrame) {
         flip |= SDL_FLIP_VERTICAL;
     }
 
-    SDL_RenderCopyEx(renderer, sprite->atlas->texture, frame, &destRect, sprite->rotation, &center, flip);
+    SDL_RenderCopyEx(renderer, atlas->texture, frame, &destRect, sprite->rotation, &center, flip);
+    CountersAdd(EngineCounter_DrawCalls, 1);
 }
 
 void SpriteDraw(Sprite *sprite, SDL_Renderer *renderer) {
@@ -3,12 +3,24 @@
 #include <SDL2/SDL.h>
 #include <stdbool.h>
 
+#include "engine/counters.h"
+#include "engine/job.h"
+#include "engine/mask.h"
+#include "engine/profile.h"
 #include "engine/str.h"
 #include "engine/util.h"
 
 // TODO(SeedyROM): Frames need durations... fuck
 typedef SDL_Rect TextureAtlasFrame;
 
+// Whether a frame needs blending, decided from its alpha channel at load time.
+// SDL has no alpha test, so a cutout with fully transparent pixels blends
+// the same as anything translucent.
+typedef enum TextureAtlasAlpha {
+  TextureAtlasAlpha_Opaque = 0,
+  TextureAtlasAlpha_Translucent = 1,
+} TextureAtlasAlpha;
+
 typedef struct TextureAtlasIndex {
   u16 numFrames;
   u32 frameIndex;
@@ -17,22 +29,31 @@ typedef struct TextureAtlasIndex {
 
 ARRAY_DEFINE(TextureAtlasFrame, TextureAtlasFrames);
 ARRAY_DEFINE(TextureAtlasIndex, TextureAtlasIndices);
+ARRAY_DEFINE(TextureAtlasAlpha, TextureAtlasAlphas);
+ARRAY_DEFINE(CollisionMask, TextureAtlasMasks);
 
 typedef struct TextureAtlas {
   Arena *arena;
   TextureAtlasIndices indices;
   TextureAtlasFrames frames;
+  TextureAtlasAlphas alphas;
+  TextureAtlasMasks masks;
   SDL_Texture *texture;
+  SDL_BlendMode blendMode;
+  SDL_BlendMode currentBlendMode;
+  bool premultiplied;
   u16 width;
   u16 height;
 } TextureAtlas;
 
 TextureAtlas *TextureAtlasCreate(Arena *arena);
-int TextureAtlasLoadSprites(SDL_Renderer *renderer, TextureAtlas *atlas,
-                            String *path);
+// Renderer can be NULL, then no texture is made and nothing can be drawn
+int TextureAtlasLoadSprites(SDL_Renderer *renderer, JobSystem *jobs,
+                            TextureAtlas *atlas, String *path);
 i64 TextureAtlasIndicesGetIndex(TextureAtlas *atlas, String *name);
 TextureAtlasFrames TextureAtlasIndicesGetFrames(TextureAtlas *atlas,
                                                 String *name);
+void TextureAtlasPremultiplyPixels(u32 *pixels, usize count);
 void TextureAtlasFree(TextureAtlas *atlas);
 
 typedef struct Sprite {
@@ -48,6 +69,8 @@ typedef struct Sprite {
 
 void SpriteFromAtlas(Sprite *sprite, TextureAtlas *atlas, String *name);
 void SpriteChange(Sprite *sprite, String *name);
+usize SpriteGetAtlasFrame(Sprite *sprite, u16 currentFrame);
+CollisionMask *SpriteGetMask(Sprite *sprite, u16 currentFrame);
 void SpriteDraw(Sprite *sprite, SDL_Renderer *renderer);
 void SpriteDrawFrame(Sprite *sprite, SDL_Renderer *renderer, u16 currentFrame);
 
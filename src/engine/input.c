@@ -0,0 +1,297 @@
+#include "engine/input.h"
+
+static const char InputRecordingMagic[8] = {'C', 'A', 'P', 'Y', 'I', 'N', 'P', 'T'};
+static const u32 InputRecordingVersion = 2;
+
+typedef struct InputRecordingHeader {
+    char magic[8];
+    u32 version;
+    u32 frameSize;
+} InputRecordingHeader;
+
+// Keys and what they press, everything else on the keyboard is ignored
+typedef struct InputKeyBinding {
+    SDL_Scancode scancode;
+    u8 button;
+} InputKeyBinding;
+
+static const InputKeyBinding InputKeyBindings[] = {
+    {SDL_SCANCODE_LEFT, InputButton_Left},
+    {SDL_SCANCODE_RIGHT, InputButton_Right},
+    {SDL_SCANCODE_UP, InputButton_Up},
+    {SDL_SCANCODE_F5, InputButton_QuickSave},
+    {SDL_SCANCODE_F9, InputButton_QuickLoad},
+    {SDL_SCANCODE_R, InputButton_Restart},
+    {SDL_SCANCODE_BACKSPACE, InputButton_Rewind},
+};
+
+// Sticks don't rest at exactly zero
+static const i16 InputStickDeadzone = 8000;
+
+void InputStateInit(InputState *state, bool controller) {
+    state->keys = 0;
+    state->controllerButtons = 0;
+    state->axisX = 0;
+    state->axisY = 0;
+    state->controller = controller;
+    state->pressed = 0;
+    state->released = 0;
+    state->changedAt = 0;
+}
+
+// Whatever the last controller was holding goes with it, the new one (if any) starts from nothing
+void InputStateSetController(InputState *state, bool connected) {
+    state->controller = connected;
+    state->controllerButtons = 0;
+    state->axisX = 0;
+    state->axisY = 0;
+}
+
+// NOTE(SeedyROM): SDL stamps events in milliseconds since init, work out how long ago that was in counter ticks.
+static u64 InputEventCounter(SDL_Event *event) {
+    u64 now = SDL_GetPerformanceCounter();
+    u32 age = SDL_GetTicks() - event->common.timestamp;
+    return now - MIN((u64)age * SDL_GetPerformanceFrequency() / 1000, now);
+}
+
+static void InputStateChanged(InputState *state, SDL_Event *event) {
+    // Only the oldest change waiting to be sampled matters for latency
+    if (state->changedAt == 0) {
+        state->changedAt = InputEventCounter(event);
+    }
+}
+
+void InputHandleEvent(InputState *state, SDL_Event *event) {
+    switch (event->type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP: {
+            if (event->key.repeat) {
+                break;
+            }
+
+            for (u32 i = 0; i < sizeof(InputKeyBindings) / sizeof(InputKeyBindings[0]); i++) {
+                if (InputKeyBindings[i].scancode == event->key.keysym.scancode) {
+                    if (event->type == SDL_KEYDOWN) {
+                        state->keys |= InputKeyBindings[i].button;
+                        state->pressed |= InputKeyBindings[i].button;
+                    } else {
+                        state->keys &= ~InputKeyBindings[i].button;
+                        state->released |= InputKeyBindings[i].button;
+                    }
+                    InputStateChanged(state, event);
+                }
+            }
+        } break;
+
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP: {
+            if (event->cbutton.button == SDL_CONTROLLER_BUTTON_A) {
+                if (event->type == SDL_CONTROLLERBUTTONDOWN) {
+                    state->controllerButtons |= InputButton_A;
+                    state->pressed |= InputButton_A;
+                } else {
+                    state->controllerButtons &= ~InputButton_A;
+                    state->released |= InputButton_A;
+                }
+                InputStateChanged(state, event);
+            }
+        } break;
+
+        case SDL_CONTROLLERAXISMOTION: {
+            // Motion inside the deadzone isn't worth timing
+            i16 *axis = event->caxis.axis == SDL_CONTROLLER_AXIS_LEFTX ? &state->axisX : event->caxis.axis == SDL_CONTROLLER_AXIS_LEFTY ? &state->axisY : NULL;
+            if (axis != NULL) {
+                bool wasOutside = *axis <= -InputStickDeadzone || *axis >= InputStickDeadzone;
+                bool isOutside = event->caxis.value <= -InputStickDeadzone || event->caxis.value >= InputStickDeadzone;
+                *axis = event->caxis.value;
+                if (wasOutside || isOutside) {
+                    InputStateChanged(state, event);
+                }
+            }
+        } break;
+
+        default: {
+        } break;
+    }
+}
+
+u64 InputStateSample(InputState *state, InputFrame *input) {
+    input->buttons = state->keys;
+    input->flags = 0;
+    input->axisX = 0;
+    input->axisY = 0;
+    input->pressed = state->pressed;
+    input->released = state->released;
+    state->pressed = 0;
+    state->released = 0;
+
+    if (state->controller) {
+        input->flags |= InputFlag_Controller;
+        input->buttons |= state->controllerButtons;
+        input->axisX = state->axisX;
+        input->axisY = state->axisY;
+    }
+
+    u64 changedAt = state->changedAt;
+    state->changedAt = 0;
+    return changedAt;
+}
+
+void InputActionsInit(InputActions *actions) {
+    actions->held = 0;
+    actions->pressed = 0;
+    actions->released = 0;
+}
+
+void InputActionsUpdate(InputActions *actions, InputFrame *input) {
+    u8 held = input->buttons;
+
+    // The stick is just another way of pressing left and right
+    if (input->flags & InputFlag_Controller) {
+        if (input->axisX <= -InputStickDeadzone) {
+            held |= InputButton_Left;
+        } else if (input->axisX >= InputStickDeadzone) {
+            held |= InputButton_Right;
+        }
+    }
+
+    // Taps shorter than a tick only show up as edges, held never sees them
+    actions->pressed = (held & ~actions->held) | input->pressed;
+    actions->released = (actions->held & ~held) | input->released;
+    actions->held = held;
+}
+
+void InputLatencyInit(InputLatency *latency) {
+    memset(latency, 0, sizeof(InputLatency));
+    latency->min = ~0ull;
+}
+
+void InputLatencySent(InputLatency *latency, u64 sequence, u64 changedAt) {
+    // Still waiting on an older change to show up, that one's the one to time
+    if (changedAt == 0 || latency->pending) {
+        return;
+    }
+
+    latency->pending = true;
+    latency->sequence = sequence;
+    latency->changedAt = changedAt;
+}
+
+u64 InputLatencyPresented(InputLatency *latency, u64 sequence, u64 presentedAt) {
+    if (!latency->pending || sequence < latency->sequence) {
+        return 0;
+    }
+
+    u64 elapsed = presentedAt > latency->changedAt ? presentedAt - latency->changedAt : 0;
+    latency->pending = false;
+    latency->count++;
+    latency->total += elapsed;
+    latency->min = MIN(latency->min, elapsed);
+    latency->max = MAX(latency->max, elapsed);
+    return elapsed;
+}
+
+void InputLatencyReport(InputLatency *latency) {
+    if (latency->count == 0) {
+        return;
+    }
+
+    f64 toMs = 1000.0 / SDL_GetPerformanceFrequency();
+    printf("Input to present: %.2fms avg, %.2fms min, %.2fms max over %llu inputs\n", latency->total * toMs / latency->count,
+           latency->min * toMs, latency->max * toMs, (unsigned long long)latency->count);
+}
+
+void InputRecorderInit(InputRecorder *recorder) {
+    recorder->mode = InputMode_Live;
+    recorder->file = NULL;
+    recorder->frames = NULL;
+    recorder->frameCount = 0;
+    recorder->cursor = 0;
+}
+
+int InputRecorderStartRecording(InputRecorder *recorder, const char *path) {
+    recorder->file = fopen(path, "wb");
+    if (recorder->file == NULL) {
+        fprintf(stderr, "Failed to open input recording: %s\n", path);
+        return 1;
+    }
+
+    InputRecordingHeader header;
+    memcpy(header.magic, InputRecordingMagic, sizeof(header.magic));
+    header.version = InputRecordingVersion;
+    header.frameSize = sizeof(InputFrame);
+    fwrite(&header, sizeof(header), 1, recorder->file);
+
+    recorder->mode = InputMode_Record;
+    recorder->frameCount = 0;
+    return 0;
+}
+
+int InputRecorderStartReplay(Arena *arena, InputRecorder *recorder, const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Failed to open input recording: %s\n", path);
+        return 1;
+    }
+
+    InputRecordingHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, InputRecordingMagic, sizeof(header.magic)) != 0 ||
+        header.version != InputRecordingVersion || header.frameSize != sizeof(InputFrame)) {
+        fprintf(stderr, "Not an input recording we can read: %s\n", path);
+        fclose(file);
+        return 1;
+    }
+
+    // Everything after the header is frames
+    fseek(file, 0, SEEK_END);
+    u64 size = ftell(file) - sizeof(header);
+    fseek(file, sizeof(header), SEEK_SET);
+
+    recorder->frameCount = size / sizeof(InputFrame);
+    recorder->frames = ArenaPushArray(arena, recorder->frameCount, InputFrame);
+    if (fread(recorder->frames, sizeof(InputFrame), recorder->frameCount, file) != recorder->frameCount) {
+        fprintf(stderr, "Failed to read input recording: %s\n", path);
+        fclose(file);
+        return 1;
+    }
+    fclose(file);
+
+    printf("Replaying %llu ticks of input from %s\n", (unsigned long long)recorder->frameCount, path);
+    recorder->mode = InputMode_Replay;
+    recorder->cursor = 0;
+    return 0;
+}
+
+// Call once per tick with the live input, false once a replay runs out
+bool InputRecorderNext(InputRecorder *recorder, InputFrame *input) {
+    switch (recorder->mode) {
+        case InputMode_Record: {
+            fwrite(input, sizeof(InputFrame), 1, recorder->file);
+            recorder->frameCount++;
+        } break;
+
+        case InputMode_Replay: {
+            if (recorder->cursor >= recorder->frameCount) {
+                *input = (InputFrame){0};
+                return false;
+            }
+            *input = recorder->frames[recorder->cursor++];
+        } break;
+
+        default: {
+        } break;
+    }
+
+    return true;
+}
+
+void InputRecorderClose(InputRecorder *recorder) {
+    if (recorder->mode == InputMode_Record && recorder->file != NULL) {
+        fclose(recorder->file);
+        printf("Recorded %llu ticks of input\n", (unsigned long long)recorder->frameCount);
+    }
+
+    recorder->file = NULL;
+    recorder->mode = InputMode_Live;
+}
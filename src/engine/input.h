@@ -0,0 +1,115 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "engine/arena.h"
+#include "engine/util.h"
+
+typedef enum InputButton {
+  InputButton_Left = 1 << 0,
+  InputButton_Right = 1 << 1,
+  InputButton_Up = 1 << 2,
+  // Controller face button
+  InputButton_A = 1 << 3,
+  InputButton_QuickSave = 1 << 4,
+  InputButton_QuickLoad = 1 << 5,
+  InputButton_Restart = 1 << 6,
+  // Held, steps back a tick every tick
+  InputButton_Rewind = 1 << 7,
+} InputButton;
+
+typedef enum InputFlag {
+  // The axes are only there when this is set, the keys count either way
+  InputFlag_Controller = 1 << 0,
+} InputFlag;
+
+// Everything gameplay is allowed to know about the devices for one tick
+typedef struct InputFrame {
+  u8 buttons;
+  u8 flags;
+  i16 axisX;
+  i16 axisY;
+  // Buttons that went down or up since the last tick, even if they went back
+  // before anything sampled them
+  u8 pressed;
+  u8 released;
+} InputFrame;
+
+// What the devices are doing right now, kept up to date from SDL events on the
+// main thread instead of polling them. Sampling it is just a copy, so it
+// doesn't matter how many things read the input each tick.
+typedef struct InputState {
+  u8 keys;
+  u8 controllerButtons;
+  i16 axisX;
+  i16 axisY;
+  bool controller;
+  // Edges since the last sample, so a tap between two samples isn't lost
+  u8 pressed;
+  u8 released;
+  // Performance counter of the oldest change that hasn't been sampled, 0 if none
+  u64 changedAt;
+} InputState;
+
+// Edges of the buttons between one tick and the next, the stick counts as
+// left and right once it's past the deadzone
+typedef struct InputActions {
+  u8 held;
+  u8 pressed;
+  u8 released;
+} InputActions;
+
+// How long a change to the input takes to make it on screen. Input is handed
+// to the simulation with a sequence number and snapshots say which one they
+// saw last, once one that includes the change is presented it gets timed.
+typedef struct InputLatency {
+  bool pending;
+  u64 sequence;
+  u64 changedAt;
+  // In performance counter ticks
+  u64 count;
+  u64 total;
+  u64 min;
+  u64 max;
+} InputLatency;
+
+typedef enum InputMode {
+  InputMode_Live = 0,
+  InputMode_Record,
+  InputMode_Replay,
+} InputMode;
+
+// Live input passes straight through, recording appends every tick to a file
+// and replaying swaps the live input for what was recorded.
+typedef struct InputRecorder {
+  InputMode mode;
+  FILE *file;
+  InputFrame *frames;
+  u64 frameCount;
+  u64 cursor;
+} InputRecorder;
+
+void InputStateInit(InputState *state, bool controller);
+// Which controller is open is up to the caller, events don't say if it opened
+void InputStateSetController(InputState *state, bool connected);
+void InputHandleEvent(InputState *state, SDL_Event *event);
+u64 InputStateSample(InputState *state, InputFrame *input);
+
+void InputActionsInit(InputActions *actions);
+void InputActionsUpdate(InputActions *actions, InputFrame *input);
+
+void InputLatencyInit(InputLatency *latency);
+void InputLatencySent(InputLatency *latency, u64 sequence, u64 changedAt);
+u64 InputLatencyPresented(InputLatency *latency, u64 sequence,
+                          u64 presentedAt);
+void InputLatencyReport(InputLatency *latency);
+
+void InputRecorderInit(InputRecorder *recorder);
+int InputRecorderStartRecording(InputRecorder *recorder, const char *path);
+int InputRecorderStartReplay(Arena *arena, InputRecorder *recorder,
+                             const char *path);
+bool InputRecorderNext(InputRecorder *recorder, InputFrame *input);
+void InputRecorderClose(InputRecorder *recorder);
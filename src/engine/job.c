@@ -0,0 +1,347 @@
+#include "engine/job.h"
+
+#include "engine/profile.h"
+
+// Which worker the current thread is, threads outside the system run jobs inline
+static _Thread_local u32 jobWorkerIndex = 0xFFFFFFFF;
+
+static bool JobQueuePush(JobQueue *queue, Job *job) {
+    i64 bottom = atomic_load_explicit(&queue->bottom, memory_order_relaxed);
+    i64 top = atomic_load_explicit(&queue->top, memory_order_acquire);
+    if (bottom - top >= JOB_RING_SIZE) {
+        return false;
+    }
+
+    atomic_store_explicit(&queue->slots[bottom & JOB_RING_MASK], job, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&queue->bottom, bottom + 1, memory_order_relaxed);
+
+    return true;
+}
+
+static Job *JobQueueTake(JobQueue *queue) {
+    i64 bottom = atomic_load_explicit(&queue->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&queue->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    i64 top = atomic_load_explicit(&queue->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        // Empty, put bottom back
+        atomic_store_explicit(&queue->bottom, bottom + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    Job *job = atomic_load_explicit(&queue->slots[bottom & JOB_RING_MASK], memory_order_relaxed);
+    if (top == bottom) {
+        // Last one, race the thieves for it
+        if (!atomic_compare_exchange_strong_explicit(&queue->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            job = NULL;
+        }
+        atomic_store_explicit(&queue->bottom, bottom + 1, memory_order_relaxed);
+    }
+
+    return job;
+}
+
+static Job *JobQueueSteal(JobQueue *queue) {
+    i64 top = atomic_load_explicit(&queue->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    i64 bottom = atomic_load_explicit(&queue->bottom, memory_order_acquire);
+    if (top >= bottom) {
+        return NULL;
+    }
+
+    Job *job = atomic_load_explicit(&queue->slots[top & JOB_RING_MASK], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&queue->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        return NULL;
+    }
+
+    return job;
+}
+
+void JobCounterInit(JobCounter *counter) {
+    atomic_init(&counter->value, 0);
+    atomic_init(&counter->waiting, NULL);
+    atomic_init(&counter->releasing, 0);
+}
+
+bool JobCounterIsDone(JobCounter *counter) {
+    // NOTE(SeedyROM): Counters usually live on the waiter's stack, so done has to mean the
+    // last decrement is finished with it too, not just that the value hit zero.
+    return atomic_load_explicit(&counter->value, memory_order_seq_cst) == 0 &&
+           atomic_load_explicit(&counter->releasing, memory_order_seq_cst) == 0;
+}
+
+static void JobExecute(JobSystem *jobs, Job *job);
+
+// Queues everything waiting on a finished counter. Both the thread that finishes it and
+// a job parking on it late can get here, swapping the list out means each job goes once.
+static void JobCounterReleaseWaiting(JobSystem *jobs, JobCounter *counter) {
+    Job *job = atomic_exchange_explicit(&counter->waiting, NULL, memory_order_seq_cst);
+    while (job != NULL) {
+        Job *next = job->nextWaiting;
+
+        // Threads that aren't workers have no queue, same deal as submitting from one
+        u32 index = jobWorkerIndex;
+        if (index == JobWorkerNone || index >= jobs->workerCount || !JobQueuePush(&jobs->workers[index].queue, job)) {
+            JobExecute(jobs, job);
+        } else if (atomic_load_explicit(&jobs->sleeping, memory_order_relaxed) > 0) {
+            SDL_SemPost(jobs->wake);
+        }
+
+        job = next;
+    }
+}
+
+static void JobCounterDecrement(JobSystem *jobs, JobCounter *counter) {
+    atomic_fetch_add_explicit(&counter->releasing, 1, memory_order_seq_cst);
+    if (atomic_fetch_sub_explicit(&counter->value, 1, memory_order_seq_cst) == 1) {
+        JobCounterReleaseWaiting(jobs, counter);
+    }
+
+    // Last touch, the counter can be gone after this
+    atomic_fetch_sub_explicit(&counter->releasing, 1, memory_order_seq_cst);
+}
+
+// Parks a job on its dependency, false if the dependency is already done
+static bool JobCounterWait(JobSystem *jobs, JobCounter *counter, Job *job) {
+    if (JobCounterIsDone(counter)) {
+        return false;
+    }
+
+    Job *head = atomic_load_explicit(&counter->waiting, memory_order_relaxed);
+    do {
+        job->nextWaiting = head;
+    } while (!atomic_compare_exchange_weak_explicit(&counter->waiting, &head, job, memory_order_seq_cst, memory_order_relaxed));
+
+    // NOTE(SeedyROM): It could have finished before we got on the list, then nobody else
+    // is coming to release us.
+    if (atomic_load_explicit(&counter->value, memory_order_seq_cst) == 0) {
+        JobCounterReleaseWaiting(jobs, counter);
+    }
+
+    return true;
+}
+
+static void JobExecute(JobSystem *jobs, Job *job) {
+    JobCounter *counter = job->counter;
+    job->function(job->data, job->start, job->end);
+
+    // Hand the slot back before signalling, waiters may submit straight away
+    atomic_store_explicit(&job->pending, false, memory_order_release);
+    if (counter != NULL) {
+        JobCounterDecrement(jobs, counter);
+    }
+}
+
+// Runs one job from our own queue or someone else's, false if there was nothing to do.
+// Everything queued is ready to go, jobs only get queued once their dependency is done.
+static bool JobWorkerRunOne(JobWorker *worker) {
+    JobSystem *jobs = worker->system;
+
+    Job *job = JobQueueTake(&worker->queue);
+    if (job == NULL) {
+        // xorshift to pick where to start stealing
+        worker->random ^= worker->random << 13;
+        worker->random ^= worker->random >> 17;
+        worker->random ^= worker->random << 5;
+
+        u32 start = worker->random % jobs->workerCount;
+        for (u32 i = 0; i < jobs->workerCount && job == NULL; i++) {
+            u32 victim = (start + i) % jobs->workerCount;
+            if (victim != worker->index) {
+                job = JobQueueSteal(&jobs->workers[victim].queue);
+            }
+        }
+    }
+
+    if (job == NULL) {
+        return false;
+    }
+
+    JobExecute(jobs, job);
+    return true;
+}
+
+static int JobWorkerThread(void *data) {
+    JobWorker *worker = data;
+    JobSystem *jobs = worker->system;
+    jobWorkerIndex = worker->index;
+    ProfileThreadName(worker->name);
+
+    while (atomic_load_explicit(&jobs->running, memory_order_acquire)) {
+        if (!JobWorkerRunOne(worker)) {
+            // Nothing to steal, nap until someone pushes work
+            atomic_fetch_add(&jobs->sleeping, 1);
+            SDL_SemWaitTimeout(jobs->wake, 1);
+            atomic_fetch_sub(&jobs->sleeping, 1);
+        }
+    }
+
+    return 0;
+}
+
+JobSystem *JobSystemCreate(Arena *arena, u32 workerCount) {
+    if (workerCount == 0) {
+        workerCount = SDL_GetCPUCount();
+    }
+    workerCount = MIN(MAX(workerCount, 1), JOB_MAX_WORKERS);
+
+    JobSystem *jobs = ArenaPushStruct(arena, JobSystem);
+    jobs->workerCount = workerCount;
+    jobs->workers = ArenaPushArray(arena, workerCount, JobWorker);
+    atomic_init(&jobs->running, true);
+    atomic_init(&jobs->sleeping, 0);
+
+    jobs->wake = SDL_CreateSemaphore(0);
+    if (jobs->wake == NULL) {
+        fprintf(stderr, "SDL_CreateSemaphore Error: %s\n", SDL_GetError());
+        exit(EXIT_FAILURE);
+    }
+
+    for (u32 i = 0; i < workerCount; i++) {
+        JobWorker *worker = &jobs->workers[i];
+        worker->system = jobs;
+        worker->index = i;
+        worker->jobs = ArenaPushArray(arena, JOB_RING_SIZE, Job);
+        for (u32 j = 0; j < JOB_RING_SIZE; j++) {
+            atomic_init(&worker->jobs[j].pending, false);
+        }
+        worker->nextJob = 0;
+        worker->random = 0x9E3779B9u * (i + 1);
+        worker->thread = NULL;
+
+        atomic_init(&worker->queue.top, 0);
+        atomic_init(&worker->queue.bottom, 0);
+        worker->queue.slots = ArenaPushArray(arena, JOB_RING_SIZE, _Atomic(Job *));
+    }
+
+    // The calling thread is worker 0, everyone else gets a thread
+    jobWorkerIndex = 0;
+    for (u32 i = 1; i < workerCount; i++) {
+        JobWorker *worker = &jobs->workers[i];
+        snprintf(worker->name, sizeof(worker->name), "capy-worker-%u", i);
+        worker->thread = SDL_CreateThread(JobWorkerThread, worker->name, worker);
+        if (worker->thread == NULL) {
+            fprintf(stderr, "SDL_CreateThread Error: %s\n", SDL_GetError());
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    printf("Job system running with %u workers\n", workerCount);
+
+    return jobs;
+}
+
+void JobSystemDestroy(JobSystem *jobs) {
+    atomic_store_explicit(&jobs->running, false, memory_order_release);
+    for (u32 i = 1; i < jobs->workerCount; i++) {
+        SDL_SemPost(jobs->wake);
+    }
+
+    for (u32 i = 1; i < jobs->workerCount; i++) {
+        SDL_WaitThread(jobs->workers[i].thread, NULL);
+    }
+
+    SDL_DestroySemaphore(jobs->wake);
+}
+
+u32 JobSystemWorkerIndex(void) {
+    return jobWorkerIndex;
+}
+
+void JobSystemAttachThread(void) {
+    jobWorkerIndex = 0;
+}
+
+void JobSystemDetachThread(void) {
+    jobWorkerIndex = JobWorkerNone;
+}
+
+// Next free job in the worker's ring, helps run jobs if every slot is taken
+static Job *JobWorkerAllocate(JobWorker *worker) {
+    for (;;) {
+        for (u32 i = 0; i < JOB_RING_SIZE; i++) {
+            Job *job = &worker->jobs[worker->nextJob++ & JOB_RING_MASK];
+            if (!atomic_load_explicit(&job->pending, memory_order_acquire)) {
+                return job;
+            }
+        }
+
+        if (!JobWorkerRunOne(worker)) {
+            SDL_Delay(0);
+        }
+    }
+}
+
+static void JobSystemSubmit(JobSystem *jobs, JobCounter *dependency, JobFunction function, void *data, u32 start, u32 end, JobCounter *counter) {
+    if (counter != NULL) {
+        atomic_fetch_add_explicit(&counter->value, 1, memory_order_relaxed);
+    }
+
+    // Not one of ours, just do the work here
+    if (jobWorkerIndex == JobWorkerNone || jobWorkerIndex >= jobs->workerCount) {
+        if (dependency != NULL) {
+            while (!JobCounterIsDone(dependency)) {
+                SDL_Delay(0);
+            }
+        }
+
+        function(data, start, end);
+        if (counter != NULL) {
+            JobCounterDecrement(jobs, counter);
+        }
+        return;
+    }
+
+    JobWorker *worker = &jobs->workers[jobWorkerIndex];
+    Job *job = JobWorkerAllocate(worker);
+    job->function = function;
+    job->data = data;
+    job->start = start;
+    job->end = end;
+    job->counter = counter;
+    job->dependency = dependency;
+    job->nextWaiting = NULL;
+    atomic_store_explicit(&job->pending, true, memory_order_relaxed);
+
+    // It gets queued by whoever finishes the dependency
+    if (dependency != NULL && JobCounterWait(jobs, dependency, job)) {
+        return;
+    }
+
+    if (!JobQueuePush(&worker->queue, job)) {
+        // Queue's full, run it now rather than drop it
+        JobExecute(jobs, job);
+        return;
+    }
+
+    if (atomic_load_explicit(&jobs->sleeping, memory_order_relaxed) > 0) {
+        SDL_SemPost(jobs->wake);
+    }
+}
+
+void JobSystemRun(JobSystem *jobs, JobFunction function, void *data, JobCounter *counter) {
+    JobSystemSubmit(jobs, NULL, function, data, 0, 1, counter);
+}
+
+void JobSystemRunAfter(JobSystem *jobs, JobCounter *dependency, JobFunction function, void *data, JobCounter *counter) {
+    JobSystemSubmit(jobs, dependency, function, data, 0, 1, counter);
+}
+
+void JobSystemParallelFor(JobSystem *jobs, u32 count, u32 batchSize, JobFunction function, void *data, JobCounter *counter) {
+    batchSize = MAX(batchSize, 1);
+    for (u32 start = 0; start < count; start += batchSize) {
+        JobSystemSubmit(jobs, NULL, function, data, start, MIN(start + batchSize, count), counter);
+    }
+}
+
+void JobSystemWait(JobSystem *jobs, JobCounter *counter) {
+    u32 index = jobWorkerIndex;
+    while (!JobCounterIsDone(counter)) {
+        // Help out instead of spinning
+        if (index == JobWorkerNone || index >= jobs->workerCount || !JobWorkerRunOne(&jobs->workers[index])) {
+            SDL_Delay(0);
+        }
+    }
+}
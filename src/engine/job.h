@@ -0,0 +1,98 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "engine/arena.h"
+#include "engine/util.h"
+
+#define JOB_MAX_WORKERS 64
+
+// Jobs each worker can have in flight, a power of two
+#define JOB_RING_SIZE 4096
+#define JOB_RING_MASK (JOB_RING_SIZE - 1)
+
+// Worker index of threads that don't belong to a job system
+static const u32 JobWorkerNone = 0xFFFFFFFF;
+
+// Runs over [start, end), single jobs get [0, 1)
+typedef void (*JobFunction)(void *data, u32 start, u32 end);
+
+struct Job;
+
+// Counts jobs that haven't finished yet, zero means everything is done. Jobs
+// that depend on it wait here instead of in a queue, whoever takes it to zero
+// queues them.
+typedef struct JobCounter {
+  atomic_int value;
+  _Atomic(struct Job *) waiting;
+  // Threads still inside a decrement, the counter can't go away until they're out
+  atomic_int releasing;
+} JobCounter;
+
+typedef struct Job {
+  JobFunction function;
+  void *data;
+  u32 start;
+  u32 end;
+  JobCounter *counter;
+  // Doesn't run until this hits zero, can be NULL
+  JobCounter *dependency;
+  // Next job waiting on the same dependency
+  struct Job *nextWaiting;
+  // Set until the job has run, its slot in the ring can't be reused before then
+  atomic_bool pending;
+} Job;
+
+// Chase-Lev deque: the owner pushes and takes from the bottom, everyone else
+// steals from the top.
+typedef struct JobQueue {
+  _Alignas(64) atomic_llong top;
+  _Alignas(64) atomic_llong bottom;
+  _Alignas(64) _Atomic(Job *) *slots;
+} JobQueue;
+
+typedef struct JobWorker {
+  struct JobSystem *system;
+  u32 index;
+  JobQueue queue;
+  // NOTE(SeedyROM): Jobs are handed out round robin from this ring, skipping
+  // any still pending. Only the owning thread hands them out so there's
+  // nothing to lock.
+  Job *jobs;
+  u32 nextJob;
+  u32 random;
+  char name[32];
+  SDL_Thread *thread;
+} JobWorker;
+
+// Worker 0 is the thread that created the system, it runs jobs while it waits
+typedef struct JobSystem {
+  JobWorker *workers;
+  u32 workerCount;
+  atomic_bool running;
+  atomic_int sleeping;
+  SDL_sem *wake;
+} JobSystem;
+
+JobSystem *JobSystemCreate(Arena *arena, u32 workerCount);
+void JobSystemDestroy(JobSystem *jobs);
+u32 JobSystemWorkerIndex(void);
+// Worker 0 can move threads, detach it from the old one before attaching the new one
+void JobSystemAttachThread(void);
+void JobSystemDetachThread(void);
+
+void JobCounterInit(JobCounter *counter);
+bool JobCounterIsDone(JobCounter *counter);
+
+void JobSystemRun(JobSystem *jobs, JobFunction function, void *data,
+                  JobCounter *counter);
+// Submit this after the jobs the dependency counts, a counter at zero is done
+void JobSystemRunAfter(JobSystem *jobs, JobCounter *dependency,
+                       JobFunction function, void *data, JobCounter *counter);
+void JobSystemParallelFor(JobSystem *jobs, u32 count, u32 batchSize,
+                          JobFunction function, void *data,
+                          JobCounter *counter);
+void JobSystemWait(JobSystem *jobs, JobCounter *counter);
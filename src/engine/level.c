@@ -0,0 +1,121 @@
+#include "engine/level.h"
+
+static bool LevelSectionFits(Level *level, u32 offset, usize size) {
+    return (offset & 3) == 0 && offset <= level->size && size <= level->size - offset;
+}
+
+static bool LevelContentsValid(Level *level) {
+    LevelHeader *header = level->header;
+
+    // The chunk grid has to cover the map exactly, streaming clamps to it
+    if (header->width == 0 || header->height == 0 ||
+        header->chunksX != (header->width + header->chunkSize - 1) / header->chunkSize ||
+        header->chunksY != (header->height + header->chunkSize - 1) / header->chunkSize) {
+        return false;
+    }
+
+    // Tile ids are 1 + a tile sprite index
+    usize cells = (usize)header->width * header->height;
+    for (usize i = 0; i < cells; i++) {
+        if (level->tiles[i] > header->tileSpriteCount) {
+            return false;
+        }
+    }
+
+    for (u32 i = 0; i < header->spawnCount; i++) {
+        if (level->spawns[i].x >= header->width || level->spawns[i].y >= header->height) {
+            return false;
+        }
+    }
+
+    u32 chunkCount = (u32)header->chunksX * header->chunksY;
+    for (u32 i = 0; i < chunkCount; i++) {
+        LevelChunk *chunk = &level->chunks[i];
+        if ((u64)chunk->firstSpawn + chunk->spawnCount > header->spawnCount) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int LevelLoad(Level *level, const char *path) {
+    int file = open(path, O_RDONLY);
+    if (file < 0) {
+        fprintf(stderr, "Failed to open level: %s\n", path);
+        return 1;
+    }
+
+    struct stat info;
+    if (fstat(file, &info) != 0 || (usize)info.st_size < sizeof(LevelHeader)) {
+        fprintf(stderr, "Not a level: %s\n", path);
+        close(file);
+        return 1;
+    }
+
+    // NOTE(SeedyROM): Private and writable so the game can poke tiles without touching the file,
+    // pages only get copied if it does.
+    level->size = info.st_size;
+    level->base = mmap(NULL, level->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+    close(file);
+    if (level->base == MAP_FAILED) {
+        fprintf(stderr, "Failed to map level: %s\n", path);
+        level->base = NULL;
+        return 1;
+    }
+
+    LevelHeader *header = level->base;
+    if (memcmp(header->magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) != 0 || header->version != LevelVersion ||
+        header->fileSize != level->size) {
+        fprintf(stderr, "Not a level we can read: %s\n", path);
+        LevelUnload(level);
+        return 1;
+    }
+
+    // Make sure every section is actually in the file before pointing at it
+    usize cells = (usize)header->width * header->height;
+    if (!LevelSectionFits(level, header->layerOffsets[LevelLayer_Collision], cells * sizeof(u8)) ||
+        !LevelSectionFits(level, header->layerOffsets[LevelLayer_Tiles], cells * sizeof(u16)) ||
+        !LevelSectionFits(level, header->tileSpritesOffset, header->tileSpriteCount * sizeof(LevelName)) ||
+        !LevelSectionFits(level, header->spawnsOffset, header->spawnCount * sizeof(LevelSpawn)) ||
+        !LevelSectionFits(level, header->chunksOffset, (usize)header->chunksX * header->chunksY * sizeof(LevelChunk)) ||
+        header->chunkSize == 0) {
+        fprintf(stderr, "Level is truncated: %s\n", path);
+        LevelUnload(level);
+        return 1;
+    }
+
+    u8 *base = level->base;
+    level->header = header;
+    level->collision = base + header->layerOffsets[LevelLayer_Collision];
+    level->tiles = (u16 *)(base + header->layerOffsets[LevelLayer_Tiles]);
+    level->tileSprites = (LevelName *)(base + header->tileSpritesOffset);
+    level->spawns = (LevelSpawn *)(base + header->spawnsOffset);
+    level->chunks = (LevelChunk *)(base + header->chunksOffset);
+
+    for (u16 i = 0; i < header->tileSpriteCount; i++) {
+        if (memchr(level->tileSprites[i].name, '\0', LEVEL_NAME_LENGTH) == NULL) {
+            fprintf(stderr, "Level has a bad tile sprite name: %s\n", path);
+            LevelUnload(level);
+            return 1;
+        }
+    }
+
+    // Everything below gets indexed with no checks once the level is running
+    if (!LevelContentsValid(level)) {
+        fprintf(stderr, "Level is corrupt: %s\n", path);
+        LevelUnload(level);
+        return 1;
+    }
+
+    return 0;
+}
+
+void LevelUnload(Level *level) {
+    if (level->base != NULL) {
+        munmap(level->base, level->size);
+    }
+
+    level->base = NULL;
+    level->size = 0;
+}
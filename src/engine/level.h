@@ -0,0 +1,88 @@
+#pragma once
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "engine/util.h"
+
+// Binary levels made by tools/levelc.c from the text levels in assets/levels.
+//
+// The file is the header, then each section 4 byte aligned at the offsets the
+// header gives. Everything is little endian and laid out exactly how it's
+// used, so loading is one mmap and a few pointer fixups, no matter how big
+// the level is.
+
+#define LEVEL_MAGIC "CAPYLVL"
+#define LEVEL_NAME_LENGTH 32
+
+static const u32 LevelVersion = 2;
+
+typedef enum LevelLayer {
+  // u8 TileFlags per cell, the TileMap uses it in place
+  LevelLayer_Collision = 0,
+  // u16 per cell, 0 is empty otherwise 1 + an index into the tile sprites
+  LevelLayer_Tiles,
+  LevelLayer_Count,
+} LevelLayer;
+
+typedef enum LevelSpawnKind {
+  LevelSpawn_Player = 0,
+  LevelSpawn_Coin,
+} LevelSpawnKind;
+
+typedef struct LevelHeader {
+  char magic[8];
+  u32 version;
+  u32 fileSize;
+  u16 width;
+  u16 height;
+  u16 tileSize;
+  u16 tileSpriteCount;
+  u32 layerOffsets[LevelLayer_Count];
+  u32 tileSpritesOffset;
+  u32 spawnsOffset;
+  u32 spawnCount;
+  // Square chunks the world streams in, the last row and column can be cut short
+  u16 chunkSize;
+  u16 chunksX;
+  u16 chunksY;
+  u16 reserved;
+  u32 chunksOffset;
+} LevelHeader;
+
+// Cell coordinates, where exactly in the cell is up to whatever spawns
+typedef struct LevelSpawn {
+  u16 kind;
+  u16 x;
+  u16 y;
+  u16 reserved;
+} LevelSpawn;
+
+// Spawns are sorted by chunk, each chunk owns a run of them
+typedef struct LevelChunk {
+  u32 firstSpawn;
+  u32 spawnCount;
+} LevelChunk;
+
+typedef struct LevelName {
+  char name[LEVEL_NAME_LENGTH];
+} LevelName;
+
+// A mapped level, every pointer here points into the file
+typedef struct Level {
+  void *base;
+  usize size;
+  LevelHeader *header;
+  u8 *collision;
+  u16 *tiles;
+  LevelName *tileSprites;
+  LevelSpawn *spawns;
+  LevelChunk *chunks;
+} Level;
+
+int LevelLoad(Level *level, const char *path);
+void LevelUnload(Level *level);
@@ -0,0 +1,75 @@
+#include "engine/mask.h"
+
+static inline u64 ReverseBits64(u64 value) {
+    value = ((value >> 1) & 0x5555555555555555ull) | ((value & 0x5555555555555555ull) << 1);
+    value = ((value >> 2) & 0x3333333333333333ull) | ((value & 0x3333333333333333ull) << 2);
+    value = ((value >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((value & 0x0F0F0F0F0F0F0F0Full) << 4);
+    value = ((value >> 8) & 0x00FF00FF00FF00FFull) | ((value & 0x00FF00FF00FF00FFull) << 8);
+    value = ((value >> 16) & 0x0000FFFF0000FFFFull) | ((value & 0x0000FFFF0000FFFFull) << 16);
+    return (value >> 32) | (value << 32);
+}
+
+void CollisionMaskBuild(Arena *arena, CollisionMask *mask, u32 *pixels, usize stride, u16 width, u16 height) {
+    mask->width = width;
+    mask->height = height;
+    mask->rows = NULL;
+
+    if (width > 64) {
+        return;
+    }
+
+    mask->rows = ArenaPushArrayZero(arena, height, u64);
+    for (u16 y = 0; y < height; y++) {
+        u64 row = 0;
+        for (u16 x = 0; x < width; x++) {
+            u8 alpha = pixels[y * stride + x] >> 24;
+            if (alpha >= CollisionMaskAlphaThreshold) {
+                row |= 1ull << x;
+            }
+        }
+        mask->rows[y] = row;
+    }
+}
+
+u64 CollisionMaskGetRow(CollisionMask *mask, u16 y, bool flipX) {
+    u64 row = mask->rows[y];
+    if (flipX) {
+        row = ReverseBits64(row) >> (64 - mask->width);
+    }
+
+    return row;
+}
+
+bool CollisionMaskOverlap(CollisionMask *a, i32 ax, i32 ay, bool aFlipX, CollisionMask *b, i32 bx, i32 by, bool bFlipX) {
+    // Only the rows both masks cover
+    i32 top = MAX(ay, by);
+    i32 bottom = MIN(ay + a->height, by + b->height);
+    if (top >= bottom) {
+        return false;
+    }
+
+    i32 left = MAX(ax, bx);
+    i32 right = MIN(ax + a->width, bx + b->width);
+    if (left >= right) {
+        return false;
+    }
+
+    // Wide frames have no mask, the boxes overlapping is all we know
+    if (a->rows == NULL || b->rows == NULL) {
+        return true;
+    }
+
+    // Line b's columns up with a's and AND the rows together
+    i32 dx = bx - ax;
+    for (i32 y = top; y < bottom; y++) {
+        u64 rowA = CollisionMaskGetRow(a, y - ay, aFlipX);
+        u64 rowB = CollisionMaskGetRow(b, y - by, bFlipX);
+
+        u64 overlap = dx >= 0 ? rowA & (rowB << dx) : (rowA << -dx) & rowB;
+        if (overlap != 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
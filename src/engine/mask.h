@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "engine/arena.h"
+#include "engine/util.h"
+
+// Pixels with at least this much alpha are solid
+static const u8 CollisionMaskAlphaThreshold = 128;
+
+// 1-bit alpha mask with one u64 per row, bit N is column N. Frames wider than
+// 64 pixels get no rows and are treated as solid boxes.
+typedef struct CollisionMask {
+  u16 width;
+  u16 height;
+  u64 *rows;
+} CollisionMask;
+
+void CollisionMaskBuild(Arena *arena, CollisionMask *mask, u32 *pixels,
+                        usize stride, u16 width, u16 height);
+u64 CollisionMaskGetRow(CollisionMask *mask, u16 y, bool flipX);
+bool CollisionMaskOverlap(CollisionMask *a, i32 ax, i32 ay, bool aFlipX,
+                          CollisionMask *b, i32 bx, i32 by, bool bFlipX);
@@ -0,0 +1,280 @@
+#include "engine/profile.h"
+
+#if CAPY_PROFILE
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static Profiler *profiler = NULL;
+static _Thread_local ProfileThread *profileThread = NULL;
+
+static inline u64 ProfileTimestamp(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return SDL_GetPerformanceCounter();
+#endif
+}
+
+// Timestamp ticks per second, measured against the performance counter since init
+static f64 ProfileTicksPerSecond(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    u64 ticks = ProfileTimestamp() - profiler->startTicks;
+    u64 counter = SDL_GetPerformanceCounter() - profiler->startCounter;
+    if (counter == 0) {
+        return (f64)SDL_GetPerformanceFrequency();
+    }
+    return (f64)ticks * SDL_GetPerformanceFrequency() / counter;
+#else
+    return (f64)SDL_GetPerformanceFrequency();
+#endif
+}
+
+void ProfilerInit(Arena *arena) {
+    profiler = ArenaPushStruct(arena, Profiler);
+    memset(profiler, 0, sizeof(Profiler));
+    atomic_init(&profiler->threadCount, 0);
+
+    // NOTE(SeedyROM): The rings are as big as the whole global arena, so they get their own.
+    // Pages nobody writes to never get touched.
+    Arena *rings = ArenaAlloc((usize)PROFILE_MAX_THREADS * PROFILE_RING_SIZE * sizeof(ProfileEvent));
+    for (u32 i = 0; i < PROFILE_MAX_THREADS; i++) {
+        profiler->threads[i].id = i;
+        profiler->threads[i].events = ArenaPushArray(rings, PROFILE_RING_SIZE, ProfileEvent);
+        atomic_init(&profiler->threads[i].eventCount, 0);
+    }
+
+    profiler->startTicks = ProfileTimestamp();
+    profiler->startCounter = SDL_GetPerformanceCounter();
+
+    // Whoever sets us up is the main thread
+    ProfilerThreadName("main");
+    profiler->frameStart = ProfileTimestamp();
+}
+
+static ProfileThread *ProfileGetThread(void) {
+    if (profileThread == NULL && profiler != NULL) {
+        u32 id = atomic_fetch_add(&profiler->threadCount, 1);
+        if (id >= PROFILE_MAX_THREADS) {
+            return NULL;
+        }
+
+        profileThread = &profiler->threads[id];
+        profileThread->name = "thread";
+    }
+
+    return profileThread;
+}
+
+void ProfilerThreadName(const char *name) {
+    ProfileThread *thread = ProfileGetThread();
+    if (thread != NULL) {
+        thread->name = name;
+    }
+}
+
+ProfileZone ProfileZoneBegin(const char *name) {
+    ProfileThread *thread = ProfileGetThread();
+    if (thread != NULL) {
+        thread->depth++;
+    }
+
+    return (ProfileZone){name, ProfileTimestamp()};
+}
+
+void ProfileZoneEnd(ProfileZone *zone) {
+    u64 end = ProfileTimestamp();
+    ProfileThread *thread = ProfileGetThread();
+    if (thread != NULL) {
+        thread->depth--;
+        u64 count = atomic_load_explicit(&thread->eventCount, memory_order_relaxed);
+        ProfileEvent *event = &thread->events[count & PROFILE_RING_MASK];
+        event->name = zone->name;
+        event->start = zone->start;
+        event->end = end;
+        event->depth = thread->depth;
+        atomic_store_explicit(&thread->eventCount, count + 1, memory_order_release);
+    }
+
+    // Ends the for loop in ProfileBlock
+    zone->name = NULL;
+}
+
+static u32 ProfileGetZoneStats(const char *name, u32 thread, u32 parent) {
+    // NOTE(SeedyROM): Zone names are string literals, so the pointer is the key
+    for (u32 i = 0; i < profiler->zoneCount; i++) {
+        ProfileZoneStats *stats = &profiler->zones[i];
+        if (stats->name == name && stats->thread == thread && stats->parent == parent) {
+            return i;
+        }
+    }
+
+    if (profiler->zoneCount == PROFILE_MAX_ZONES) {
+        return ProfileNoParent;
+    }
+
+    ProfileZoneStats *stats = &profiler->zones[profiler->zoneCount];
+    memset(stats, 0, sizeof(ProfileZoneStats));
+    stats->name = name;
+    stats->thread = thread;
+    stats->parent = parent;
+    return profiler->zoneCount++;
+}
+
+// Rolls one thread's zones since the last frame into the stats
+static void ProfileCollectThread(ProfileThread *thread) {
+    u64 count = atomic_load_explicit(&thread->eventCount, memory_order_acquire);
+
+    // Only look at what's still in the ring
+    u64 first = thread->frameEvent;
+    if (count - first > PROFILE_RING_SIZE) {
+        first = count - PROFILE_RING_SIZE;
+    }
+
+    // NOTE(SeedyROM): Stop after the last zone that ended at the top. Anything after it is inside a zone that's
+    // still open (the sim thread is usually halfway through a tick), it waits for the next frame so it ends up
+    // under its parent instead of at the top.
+    u64 last = count;
+    while (last > first && thread->events[(last - 1) & PROFILE_RING_MASK].depth != 0) {
+        last--;
+    }
+    count = last;
+
+    // Events are written as zones end, so walking backwards a zone always comes
+    // before the ones inside it. Whatever was last seen one level up is the parent.
+    u32 parents[PROFILE_MAX_DEPTH];
+    for (u32 i = 0; i < PROFILE_MAX_DEPTH; i++) {
+        parents[i] = ProfileNoParent;
+    }
+
+    for (u64 i = count; i > first; i--) {
+        ProfileEvent *event = &thread->events[(i - 1) & PROFILE_RING_MASK];
+        if (event->depth >= PROFILE_MAX_DEPTH) {
+            continue;
+        }
+
+        u32 parent = event->depth > 0 ? parents[event->depth - 1] : ProfileNoParent;
+        u32 index = ProfileGetZoneStats(event->name, thread->id, parent);
+        parents[event->depth] = index;
+        if (index != ProfileNoParent) {
+            profiler->zones[index].frameTicks += event->end - event->start;
+            profiler->zones[index].calls++;
+        }
+    }
+
+    thread->frameEvent = count;
+}
+
+// Rolls every thread's zones for this frame into the totals, call it from the main thread
+void ProfilerFrameEnd(void) {
+    if (profiler == NULL) {
+        return;
+    }
+
+    u64 now = ProfileTimestamp();
+
+    // NOTE(SeedyROM): Other threads keep writing while we read. That's fine unless one
+    // of them laps its whole ring within a frame.
+    u32 threadCount = MIN(atomic_load(&profiler->threadCount), PROFILE_MAX_THREADS);
+    for (u32 t = 0; t < threadCount; t++) {
+        ProfileCollectThread(&profiler->threads[t]);
+    }
+
+    for (u32 i = 0; i < profiler->zoneCount; i++) {
+        ProfileZoneStats *stats = &profiler->zones[i];
+        stats->totalTicks += stats->frameTicks;
+        stats->maxFrameTicks = MAX(stats->maxFrameTicks, stats->frameTicks);
+        stats->frameTicks = 0;
+    }
+
+    u64 frameTicks = now - profiler->frameStart;
+    profiler->totalFrameTicks += frameTicks;
+    profiler->maxFrameTicks = MAX(profiler->maxFrameTicks, frameTicks);
+    profiler->frameCount++;
+    profiler->frameStart = now;
+}
+
+static void ProfileReportZones(u32 thread, u32 parent, u32 depth, f64 msPerTick, f64 frames) {
+    // Zones get added walking backwards, so the other way round is the order they first ran in
+    for (u32 i = profiler->zoneCount; i-- > 0;) {
+        ProfileZoneStats *stats = &profiler->zones[i];
+        if (stats->thread != thread || stats->parent != parent) {
+            continue;
+        }
+
+        printf("    %*s%-*s avg %8.3fms  max %8.3fms  calls/frame %6.1f\n", depth * 2, "", 28 - depth * 2, stats->name,
+               stats->totalTicks * msPerTick / frames, stats->maxFrameTicks * msPerTick, stats->calls / frames);
+        ProfileReportZones(thread, i, depth + 1, msPerTick, frames);
+    }
+}
+
+void ProfilerReport(void) {
+    if (profiler == NULL || profiler->frameCount == 0) {
+        return;
+    }
+
+    f64 msPerTick = 1000.0 / ProfileTicksPerSecond();
+    f64 frames = (f64)profiler->frameCount;
+
+    printf("Profile over %llu frames: avg %.3fms, max %.3fms\n", (unsigned long long)profiler->frameCount,
+           profiler->totalFrameTicks * msPerTick / frames, profiler->maxFrameTicks * msPerTick);
+
+    // Each thread's zones as a tree, nested zones under the one they ran in
+    u32 threadCount = MIN(atomic_load(&profiler->threadCount), PROFILE_MAX_THREADS);
+    for (u32 t = 0; t < threadCount; t++) {
+        bool hasZones = false;
+        for (u32 i = 0; i < profiler->zoneCount && !hasZones; i++) {
+            hasZones = profiler->zones[i].thread == t;
+        }
+        if (!hasZones) {
+            continue;
+        }
+
+        printf("  %s\n", profiler->threads[t].name);
+        ProfileReportZones(t, ProfileNoParent, 0, msPerTick, frames);
+    }
+}
+
+// NOTE(SeedyROM): Call this once the workers are done, their rings are read without syncing
+int ProfilerWriteChromeTrace(const char *path) {
+    if (profiler == NULL || path == NULL) {
+        return 1;
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Failed to open trace file: %s\n", path);
+        return 1;
+    }
+
+    f64 usPerTick = 1000000.0 / ProfileTicksPerSecond();
+    bool first = true;
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    u32 threadCount = MIN(atomic_load(&profiler->threadCount), PROFILE_MAX_THREADS);
+    for (u32 t = 0; t < threadCount; t++) {
+        ProfileThread *thread = &profiler->threads[t];
+
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", thread->id, thread->name);
+        first = false;
+
+        u64 count = atomic_load_explicit(&thread->eventCount, memory_order_acquire);
+        u64 start = count > PROFILE_RING_SIZE ? count - PROFILE_RING_SIZE : 0;
+        for (u64 i = start; i < count; i++) {
+            ProfileEvent *event = &thread->events[i & PROFILE_RING_MASK];
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    event->name, thread->id,
+                    (event->start - profiler->startTicks) * usPerTick,
+                    (event->end - event->start) * usPerTick);
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    printf("Wrote trace to %s\n", path);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "engine/arena.h"
+#include "engine/util.h"
+
+// Build with -DCAPY_PROFILE=ON to turn this on, otherwise every macro below
+// compiles to nothing and ProfileBlock is just a plain block.
+#ifndef CAPY_PROFILE
+#define CAPY_PROFILE 0
+#endif
+
+#define PROFILE_MAX_THREADS 64
+#define PROFILE_MAX_ZONES 256
+#define PROFILE_MAX_DEPTH 32
+
+// Events each thread keeps, a power of two, old ones get overwritten
+#define PROFILE_RING_SIZE (1u << 16)
+#define PROFILE_RING_MASK (PROFILE_RING_SIZE - 1)
+
+#if CAPY_PROFILE
+
+typedef struct ProfileEvent {
+  const char *name;
+  u64 start;
+  u64 end;
+  u32 depth;
+} ProfileEvent;
+
+// Only the owning thread writes its ring, the count is published after each
+// event so the main thread can read up to it
+typedef struct ProfileThread {
+  const char *name;
+  u32 id;
+  ProfileEvent *events;
+  _Atomic u64 eventCount;
+  u32 depth;
+  // Where the main thread got up to, only it touches this
+  u64 frameEvent;
+} ProfileThread;
+
+typedef struct ProfileZone {
+  const char *name;
+  u64 start;
+} ProfileZone;
+
+// Zones summed up over every frame, one per place in the call tree of each
+// thread
+typedef struct ProfileZoneStats {
+  const char *name;
+  u32 thread;
+  // Index of the enclosing zone, ProfileNoParent at the top
+  u32 parent;
+  u64 totalTicks;
+  u64 maxFrameTicks;
+  u64 frameTicks;
+  u64 calls;
+} ProfileZoneStats;
+
+static const u32 ProfileNoParent = 0xFFFFFFFF;
+
+typedef struct Profiler {
+  ProfileThread threads[PROFILE_MAX_THREADS];
+  atomic_uint threadCount;
+
+  // Timestamps are raw TSC ticks, these map them onto real time
+  u64 startTicks;
+  u64 startCounter;
+
+  ProfileZoneStats zones[PROFILE_MAX_ZONES];
+  u32 zoneCount;
+  u64 frameStart;
+  u64 frameCount;
+  u64 totalFrameTicks;
+  u64 maxFrameTicks;
+} Profiler;
+
+void ProfilerInit(Arena *arena);
+void ProfilerThreadName(const char *name);
+ProfileZone ProfileZoneBegin(const char *name);
+void ProfileZoneEnd(ProfileZone *zone);
+void ProfilerFrameEnd(void);
+void ProfilerReport(void);
+int ProfilerWriteChromeTrace(const char *path);
+
+#define ProfileInit(arena) ProfilerInit(arena)
+#define ProfileThreadName(name) ProfilerThreadName(name)
+#define ProfileBlock(zoneName)                                                 \
+  for (ProfileZone _profileZone = ProfileZoneBegin(zoneName);                  \
+       _profileZone.name != NULL; ProfileZoneEnd(&_profileZone))
+#define ProfileFrameEnd() ProfilerFrameEnd()
+#define ProfileReport() ProfilerReport()
+#define ProfileWriteChromeTrace(path) ProfilerWriteChromeTrace(path)
+
+#else
+
+#define ProfileInit(arena) ((void)0)
+#define ProfileThreadName(name) ((void)0)
+#define ProfileBlock(zoneName)
+#define ProfileFrameEnd() ((void)0)
+#define ProfileReport() ((void)0)
+#define ProfileWriteChromeTrace(path) ((void)0)
+
+#endif
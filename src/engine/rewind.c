@@ -0,0 +1,287 @@
+#include "engine/rewind.h"
+
+// Encoded as runs: a header of how many words are unchanged then how many
+// changed, followed by the changed words XORed with the base
+typedef struct RewindRun {
+    u32 skip;
+    u32 literal;
+} RewindRun;
+
+// FNV-1a, a word at a time
+static const u64 RewindHashBasis = 0xCBF29CE484222325ull;
+static const u64 RewindHashPrime = 0x100000001B3ull;
+
+// Unchanged stretches get skipped this many words at a time
+static const usize RewindBlockWords = 32;
+
+static inline u64 RewindWord(u64 *words, usize count, usize i) {
+    return i < count ? words[i] : 0;
+}
+
+// XOR current against base and squeeze out the zeros, false if it doesn't fit
+static bool RewindEncode(u64 *current, usize words, u64 *base, usize baseWords, u8 *out, usize capacity, usize *size) {
+    usize offset = 0;
+    usize i = 0;
+    usize shared = MIN(words, baseWords);
+    while (i < words) {
+        RewindRun run = {0, 0};
+        usize skipStart = i;
+        // NOTE(SeedyROM): Most of the arena is the same as the keyframe, memcmp gets through it a lot faster than
+        // going a word at a time.
+        while (i + RewindBlockWords <= shared && memcmp(current + i, base + i, RewindBlockWords * sizeof(u64)) == 0) {
+            i += RewindBlockWords;
+        }
+        while (i < words && current[i] == RewindWord(base, baseWords, i)) {
+            i++;
+        }
+        run.skip = (u32)(i - skipStart);
+
+        usize literalStart = i;
+        while (i < words && current[i] != RewindWord(base, baseWords, i)) {
+            run.literal++;
+            i++;
+        }
+
+        // Nothing changed at the end, no need to say so
+        if (run.literal == 0) {
+            break;
+        }
+
+        if (offset + sizeof(RewindRun) + run.literal * sizeof(u64) > capacity) {
+            return false;
+        }
+
+        memcpy(out + offset, &run, sizeof(RewindRun));
+        offset += sizeof(RewindRun);
+        for (usize j = literalStart; j < i; j++) {
+            u64 delta = current[j] ^ RewindWord(base, baseWords, j);
+            memcpy(out + offset, &delta, sizeof(u64));
+            offset += sizeof(u64);
+        }
+    }
+
+    *size = offset;
+    return true;
+}
+
+// XORs the runs back onto target, which has to start out as the base
+static void RewindDecode(u8 *data, usize size, u64 *target) {
+    usize offset = 0;
+    usize i = 0;
+    while (offset < size) {
+        RewindRun run;
+        memcpy(&run, data + offset, sizeof(RewindRun));
+        offset += sizeof(RewindRun);
+
+        i += run.skip;
+        for (u32 j = 0; j < run.literal; j++) {
+            u64 delta;
+            memcpy(&delta, data + offset, sizeof(u64));
+            offset += sizeof(u64);
+            target[i++] ^= delta;
+        }
+    }
+}
+
+static inline usize RewindWords(usize bytes) {
+    return (bytes + sizeof(u64) - 1) / sizeof(u64);
+}
+
+// Worst case is every other word changing, a header for each changed word
+static inline usize RewindEncodeBound(usize bytes) {
+    usize words = RewindWords(bytes);
+    return words * sizeof(u64) + (words + 1) / 2 * sizeof(RewindRun);
+}
+
+void RewindBufferInit(Arena *arena, RewindBuffer *rewind, Arena *state, u32 keyframeInterval, u32 segmentCount) {
+    if (keyframeInterval == 0 || segmentCount == 0) {
+        printf("RewindBufferInit: needs at least one segment of one tick\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // NOTE(SeedyROM): The arena is read a word at a time, its base comes from malloc so it's aligned.
+    rewind->state = state;
+    rewind->keyframeInterval = keyframeInterval;
+    rewind->keyframe = ArenaPushArray(arena, RewindWords(state->size), u64);
+    rewind->keyframeUsed = 0;
+    rewind->segmentCapacity = RewindEncodeBound(state->size);
+    rewind->segmentCount = segmentCount;
+    rewind->segments = ArenaPushArray(arena, segmentCount, RewindSegment);
+
+    // NOTE(SeedyROM): Mostly untouched, a segment only gets as big as what's stored in it, so it gets its own arena
+    // instead of eating the caller's.
+    rewind->memory = ArenaAlloc(segmentCount * rewind->segmentCapacity);
+    for (u32 i = 0; i < segmentCount; i++) {
+        RewindSegment *segment = &rewind->segments[i];
+        segment->data = ArenaPushArray(rewind->memory, rewind->segmentCapacity, u8);
+        segment->frameEnds = ArenaPushArray(arena, keyframeInterval, usize);
+        segment->frameUsed = ArenaPushArray(arena, keyframeInterval, usize);
+    }
+
+    RewindBufferClear(rewind);
+}
+
+void RewindBufferFree(RewindBuffer *rewind) {
+    ArenaFree(rewind->memory);
+    rewind->memory = NULL;
+}
+
+void RewindBufferClear(RewindBuffer *rewind) {
+    rewind->current = 0;
+    rewind->filled = 0;
+    rewind->rawBytes = 0;
+    rewind->storedBytes = 0;
+    for (u32 i = 0; i < rewind->segmentCount; i++) {
+        rewind->segments[i].size = 0;
+        rewind->segments[i].firstTick = 0;
+        rewind->segments[i].frameCount = 0;
+    }
+}
+
+static void RewindBufferStartSegment(RewindBuffer *rewind, u64 tick) {
+    // Reuses the oldest segment once they're all full
+    rewind->current = rewind->filled == 0 ? 0 : (rewind->current + 1) % rewind->segmentCount;
+    rewind->filled = MIN(rewind->filled + 1, rewind->segmentCount);
+
+    RewindSegment *segment = &rewind->segments[rewind->current];
+    segment->firstTick = tick;
+    segment->frameCount = 0;
+    segment->size = 0;
+
+    Arena *state = rewind->state;
+    usize words = RewindWords(state->used);
+    memcpy(rewind->keyframe, state->base, words * sizeof(u64));
+    rewind->keyframeUsed = state->used;
+
+    // Can't happen with segments sized for the whole arena, but losing the history beats losing the game
+    usize size = 0;
+    if (!RewindEncode(state->base, words, NULL, 0, segment->data, rewind->segmentCapacity, &size)) {
+        printf("RewindBufferCapture: a keyframe of %zu bytes doesn't fit in %zu, dropping the history\n", state->used, rewind->segmentCapacity);
+        RewindBufferClear(rewind);
+        return;
+    }
+
+    segment->size = size;
+    segment->frameEnds[0] = size;
+    segment->frameUsed[0] = state->used;
+    segment->frameCount = 1;
+    rewind->storedBytes += size;
+}
+
+void RewindBufferCapture(RewindBuffer *rewind, u64 tick) {
+    Arena *state = rewind->state;
+    rewind->rawBytes += state->used;
+
+    // Anything that isn't the next tick, like loading a save, makes the history meaningless
+    if (rewind->filled > 0 && tick != RewindBufferNewest(rewind) + 1) {
+        RewindBufferClear(rewind);
+        rewind->rawBytes += state->used;
+    }
+
+    RewindSegment *segment = &rewind->segments[rewind->current];
+    if (rewind->filled > 0 && segment->frameCount < rewind->keyframeInterval) {
+        usize size = 0;
+        if (RewindEncode(state->base, RewindWords(state->used), rewind->keyframe, RewindWords(rewind->keyframeUsed),
+                         segment->data + segment->size, rewind->segmentCapacity - segment->size, &size)) {
+            segment->size += size;
+            segment->frameEnds[segment->frameCount] = segment->size;
+            segment->frameUsed[segment->frameCount] = state->used;
+            segment->frameCount++;
+            rewind->storedBytes += size;
+            return;
+        }
+
+        // Out of room, the next keyframe comes early
+    }
+
+    RewindBufferStartSegment(rewind, tick);
+}
+
+bool RewindBufferHas(RewindBuffer *rewind, u64 tick) {
+    return rewind->filled > 0 && tick >= RewindBufferOldest(rewind) && tick <= RewindBufferNewest(rewind);
+}
+
+u64 RewindBufferOldest(RewindBuffer *rewind) {
+    if (rewind->filled == 0) {
+        return 0;
+    }
+
+    u32 oldest = (rewind->current + rewind->segmentCount - (rewind->filled - 1)) % rewind->segmentCount;
+    return rewind->segments[oldest].firstTick;
+}
+
+u64 RewindBufferNewest(RewindBuffer *rewind) {
+    if (rewind->filled == 0) {
+        return 0;
+    }
+
+    RewindSegment *segment = &rewind->segments[rewind->current];
+    return segment->firstTick + segment->frameCount - 1;
+}
+
+bool RewindBufferRestore(RewindBuffer *rewind, u64 tick) {
+    if (!RewindBufferHas(rewind, tick)) {
+        return false;
+    }
+
+    // Newest first, rewinding is usually only a tick or two
+    u32 index = rewind->current;
+    u32 newer = 0;
+    while (tick < rewind->segments[index].firstTick) {
+        index = (index + rewind->segmentCount - 1) % rewind->segmentCount;
+        newer++;
+    }
+
+    RewindSegment *segment = &rewind->segments[index];
+    u32 frame = (u32)(tick - segment->firstTick);
+
+    // The keyframe is what every tick after it is XORed against, so it has to come back too
+    usize keyWords = RewindWords(segment->frameUsed[0]);
+    memset(rewind->keyframe, 0, keyWords * sizeof(u64));
+    RewindDecode(segment->data, segment->frameEnds[0], rewind->keyframe);
+    rewind->keyframeUsed = segment->frameUsed[0];
+
+    Arena *state = rewind->state;
+    u64 *words = state->base;
+    usize used = segment->frameUsed[frame];
+    usize wordCount = RewindWords(used);
+    memcpy(words, rewind->keyframe, MIN(keyWords, wordCount) * sizeof(u64));
+    if (wordCount > keyWords) {
+        memset(words + keyWords, 0, (wordCount - keyWords) * sizeof(u64));
+    }
+    if (frame > 0) {
+        RewindDecode(segment->data + segment->frameEnds[frame - 1], segment->frameEnds[frame] - segment->frameEnds[frame - 1], words);
+    }
+    state->used = used;
+
+    // Everything after this tick is a future that won't happen now
+    segment->frameCount = frame + 1;
+    segment->size = segment->frameEnds[frame];
+    rewind->current = index;
+    rewind->filled -= newer;
+
+    return true;
+}
+
+u64 RewindBufferHashState(RewindBuffer *rewind) {
+    u64 *words = rewind->state->base;
+    usize used = rewind->state->used;
+    usize count = used / sizeof(u64);
+
+    u64 hash = RewindHashBasis;
+    for (usize i = 0; i < count; i++) {
+        hash ^= words[i];
+        hash *= RewindHashPrime;
+    }
+
+    // Whatever's past used in the last word is left over from before, it doesn't count
+    usize tail = used % sizeof(u64);
+    if (tail > 0) {
+        u64 last = 0;
+        memcpy(&last, words + count, tail);
+        hash ^= last;
+        hash *= RewindHashPrime;
+    }
+
+    return hash;
+}
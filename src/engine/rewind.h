@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine/arena.h"
+#include "engine/util.h"
+
+// A keyframe and the ticks stored against it
+typedef struct RewindSegment {
+  u8 *data;
+  usize size;
+  u64 firstTick;
+  u32 frameCount;
+  // Where each tick's encoding ends in data, tick 0 is the keyframe
+  usize *frameEnds;
+  // How much of the arena was in use at each tick
+  usize *frameUsed;
+} RewindSegment;
+
+// The last few seconds of an arena, one capture per tick. Every
+// keyframeInterval ticks the whole arena is stored, every tick in between is
+// stored as an XOR against that keyframe. Most of the arena doesn't change
+// from tick to tick so the XOR is mostly zero words, which get run length
+// encoded away. Going back to a tick decodes its keyframe and XORs the tick
+// back on top, and forgets everything after it so the simulation can carry on
+// from there.
+typedef struct RewindBuffer {
+  Arena *state;
+  u32 keyframeInterval;
+  // The current segment's keyframe, decoded, so captures can XOR against it
+  u64 *keyframe;
+  usize keyframeUsed;
+  // Sized so a keyframe of the whole arena always fits, deltas share it
+  usize segmentCapacity;
+  Arena *memory;
+  RewindSegment *segments;
+  u32 segmentCount;
+  // Newest segment, and how many of them hold anything
+  u32 current;
+  u32 filled;
+  // What the captures would have cost stored whole, and what they did
+  u64 rawBytes;
+  u64 storedBytes;
+} RewindBuffer;
+
+void RewindBufferInit(Arena *arena, RewindBuffer *rewind, Arena *state,
+                      u32 keyframeInterval, u32 segmentCount);
+void RewindBufferFree(RewindBuffer *rewind);
+void RewindBufferClear(RewindBuffer *rewind);
+void RewindBufferCapture(RewindBuffer *rewind, u64 tick);
+bool RewindBufferRestore(RewindBuffer *rewind, u64 tick);
+bool RewindBufferHas(RewindBuffer *rewind, u64 tick);
+u64 RewindBufferOldest(RewindBuffer *rewind);
+u64 RewindBufferNewest(RewindBuffer *rewind);
+u64 RewindBufferHashState(RewindBuffer *rewind);
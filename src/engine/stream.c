@@ -0,0 +1,228 @@
+#include "engine/stream.h"
+
+// Copies the chunk's tiles out of the level so they're contiguous, runs on the loader
+static void WorldStreamDecode(WorldStream *stream, StreamChunk *chunk) {
+    Level *level = stream->level;
+    LevelHeader *header = level->header;
+    u32 size = stream->chunkSize;
+    u32 startX = chunk->chunkX * size;
+    u32 startY = chunk->chunkY * size;
+    u32 width = MIN(size, header->width - startX);
+    u32 height = MIN(size, header->height - startY);
+
+    // NOTE(SeedyROM): Reading the collision rows here faults their pages in off the main thread,
+    // the TileMap reads them straight out of the mapped level later.
+    volatile u8 touched = 0;
+    for (u32 y = 0; y < size; y++) {
+        u16 *row = &chunk->tiles[y * size];
+        if (y >= height) {
+            memset(row, 0, size * sizeof(u16));
+            continue;
+        }
+
+        usize cell = (usize)(startY + y) * header->width + startX;
+        memcpy(row, &level->tiles[cell], width * sizeof(u16));
+        memset(row + width, 0, (size - width) * sizeof(u16));
+        touched ^= level->collision[cell];
+    }
+    (void)touched;
+
+    LevelChunk *info = &level->chunks[chunk->chunkY * stream->chunksX + chunk->chunkX];
+    chunk->firstSpawn = info->firstSpawn;
+    chunk->spawnCount = info->spawnCount;
+    chunk->spawns = &level->spawns[info->firstSpawn];
+}
+
+static void WorldStreamDrain(WorldStream *stream) {
+    u64 tail = atomic_load_explicit(&stream->tail, memory_order_relaxed);
+    u64 head = atomic_load_explicit(&stream->head, memory_order_acquire);
+    for (; tail < head; tail++) {
+        StreamChunk *chunk = &stream->pool[stream->requests[tail & STREAM_RING_MASK]];
+        ProfileBlock("WorldStreamDecode") {
+            WorldStreamDecode(stream, chunk);
+        }
+        atomic_store_explicit(&chunk->state, StreamChunkState_Loaded, memory_order_release);
+        atomic_store_explicit(&stream->tail, tail + 1, memory_order_release);
+    }
+}
+
+static int WorldStreamLoaderThread(void *data) {
+    WorldStream *stream = data;
+    ProfileThreadName("capy-stream");
+
+    while (atomic_load_explicit(&stream->running, memory_order_acquire)) {
+        SDL_SemWaitTimeout(stream->wake, 100);
+        WorldStreamDrain(stream);
+    }
+
+    return 0;
+}
+
+void WorldStreamInit(Arena *arena, WorldStream *stream, Level *level, u32 activeRadius, u32 loadRadius, StreamChunkCallback activate, StreamChunkCallback deactivate, void *callbackData) {
+    // Everything that can be loaded at once has to fit in the pool, unloading lags a chunk behind
+    u32 span = 2 * (loadRadius + 1) + 1;
+    if (activeRadius > loadRadius || span * span > STREAM_POOL_SIZE) {
+        printf("WorldStreamInit: radii %u/%u need more than %u chunks\n", activeRadius, loadRadius, STREAM_POOL_SIZE);
+        exit(EXIT_FAILURE);
+    }
+
+    LevelHeader *header = level->header;
+    stream->level = level;
+    stream->chunkSize = header->chunkSize;
+    stream->chunksX = header->chunksX;
+    stream->chunksY = header->chunksY;
+    stream->activeRadius = activeRadius;
+    stream->loadRadius = loadRadius;
+
+    u32 chunkCount = stream->chunksX * stream->chunksY;
+    stream->slots = ArenaPushArray(arena, chunkCount, u16);
+    for (u32 i = 0; i < chunkCount; i++) {
+        stream->slots[i] = StreamSlotNone;
+    }
+
+    // Hand out slot 0 first
+    stream->freeCount = 0;
+    for (u32 i = STREAM_POOL_SIZE; i > 0; i--) {
+        StreamChunk *chunk = &stream->pool[i - 1];
+        chunk->tiles = ArenaPushArray(arena, stream->chunkSize * stream->chunkSize, u16);
+        chunk->spawns = NULL;
+        chunk->firstSpawn = 0;
+        chunk->spawnCount = 0;
+        atomic_init(&chunk->state, StreamChunkState_Free);
+        stream->freeSlots[stream->freeCount++] = i - 1;
+    }
+
+    stream->activate = activate;
+    stream->deactivate = deactivate;
+    stream->callbackData = callbackData;
+
+    atomic_init(&stream->head, 0);
+    atomic_init(&stream->tail, 0);
+    atomic_init(&stream->running, true);
+
+    stream->wake = SDL_CreateSemaphore(0);
+    if (stream->wake == NULL) {
+        fprintf(stderr, "SDL_CreateSemaphore Error: %s\n", SDL_GetError());
+        exit(EXIT_FAILURE);
+    }
+
+    stream->loader = SDL_CreateThread(WorldStreamLoaderThread, "capy-stream", stream);
+    if (stream->loader == NULL) {
+        fprintf(stderr, "SDL_CreateThread Error: %s\n", SDL_GetError());
+        exit(EXIT_FAILURE);
+    }
+}
+
+static u32 WorldStreamDistance(StreamChunk *chunk, i32 focusX, i32 focusY) {
+    i32 dx = abs((i32)chunk->chunkX - focusX);
+    i32 dy = abs((i32)chunk->chunkY - focusY);
+    return MAX(dx, dy);
+}
+
+// Without notify the states change but the callbacks don't run
+static void WorldStreamRefocus(WorldStream *stream, Vec2 focus, bool notify) {
+    LevelHeader *header = stream->level->header;
+    f32 chunkPixels = (f32)header->tileSize * stream->chunkSize;
+    i32 focusX = MIN(MAX((i32)floorf(focus.x / chunkPixels), 0), stream->chunksX - 1);
+    i32 focusY = MIN(MAX((i32)floorf(focus.y / chunkPixels), 0), stream->chunksY - 1);
+
+    // Deactivate whatever's drifted out of range, and drop what's well past it
+    for (u32 i = 0; i < STREAM_POOL_SIZE; i++) {
+        StreamChunk *chunk = &stream->pool[i];
+        int state = atomic_load_explicit(&chunk->state, memory_order_acquire);
+        if (state == StreamChunkState_Free || state == StreamChunkState_Loading) {
+            continue;
+        }
+
+        u32 distance = WorldStreamDistance(chunk, focusX, focusY);
+        if (state == StreamChunkState_Active && distance > stream->activeRadius) {
+            if (notify) {
+                stream->deactivate(stream->callbackData, chunk);
+            }
+            state = StreamChunkState_Loaded;
+            atomic_store_explicit(&chunk->state, state, memory_order_relaxed);
+        }
+
+        if (state == StreamChunkState_Loaded && distance > stream->loadRadius + 1) {
+            stream->slots[chunk->chunkY * stream->chunksX + chunk->chunkX] = StreamSlotNone;
+            atomic_store_explicit(&chunk->state, StreamChunkState_Free, memory_order_relaxed);
+            stream->freeSlots[stream->freeCount++] = i;
+        }
+    }
+
+    // Queue loads for everything close enough that isn't loaded yet
+    i32 loadRadius = stream->loadRadius;
+    bool queued = false;
+    for (i32 y = MAX(focusY - loadRadius, 0); y <= MIN(focusY + loadRadius, stream->chunksY - 1); y++) {
+        for (i32 x = MAX(focusX - loadRadius, 0); x <= MIN(focusX + loadRadius, stream->chunksX - 1); x++) {
+            u16 *slot = &stream->slots[y * stream->chunksX + x];
+            if (*slot != StreamSlotNone) {
+                continue;
+            }
+
+            *slot = stream->freeSlots[--stream->freeCount];
+            StreamChunk *chunk = &stream->pool[*slot];
+            chunk->chunkX = x;
+            chunk->chunkY = y;
+            atomic_store_explicit(&chunk->state, StreamChunkState_Loading, memory_order_relaxed);
+
+            u64 head = atomic_load_explicit(&stream->head, memory_order_relaxed);
+            stream->requests[head & STREAM_RING_MASK] = *slot;
+            atomic_store_explicit(&stream->head, head + 1, memory_order_release);
+            queued = true;
+        }
+    }
+    if (queued) {
+        SDL_SemPost(stream->wake);
+    }
+
+    // Activate the nearest, waiting on the loader if it hasn't got to one yet
+    i32 activeRadius = stream->activeRadius;
+    for (i32 y = MAX(focusY - activeRadius, 0); y <= MIN(focusY + activeRadius, stream->chunksY - 1); y++) {
+        for (i32 x = MAX(focusX - activeRadius, 0); x <= MIN(focusX + activeRadius, stream->chunksX - 1); x++) {
+            StreamChunk *chunk = &stream->pool[stream->slots[y * stream->chunksX + x]];
+            int state = atomic_load_explicit(&chunk->state, memory_order_acquire);
+            if (state == StreamChunkState_Loading) {
+                ProfileBlock("WorldStreamWait") {
+                    while (state == StreamChunkState_Loading) {
+                        SDL_Delay(0);
+                        state = atomic_load_explicit(&chunk->state, memory_order_acquire);
+                    }
+                }
+            }
+
+            if (state == StreamChunkState_Loaded) {
+                if (notify) {
+                    stream->activate(stream->callbackData, chunk);
+                }
+                atomic_store_explicit(&chunk->state, StreamChunkState_Active, memory_order_relaxed);
+            }
+        }
+    }
+}
+
+void WorldStreamUpdate(WorldStream *stream, Vec2 focus) {
+    WorldStreamRefocus(stream, focus, true);
+}
+
+void WorldStreamReset(WorldStream *stream, Vec2 focus) {
+    WorldStreamRefocus(stream, focus, false);
+}
+
+u32 WorldStreamCount(WorldStream *stream, StreamChunkState state) {
+    u32 count = 0;
+    for (u32 i = 0; i < STREAM_POOL_SIZE; i++) {
+        if (atomic_load_explicit(&stream->pool[i].state, memory_order_relaxed) == (int)state) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+void WorldStreamDestroy(WorldStream *stream) {
+    atomic_store_explicit(&stream->running, false, memory_order_release);
+    SDL_SemPost(stream->wake);
+    SDL_WaitThread(stream->loader, NULL);
+    SDL_DestroySemaphore(stream->wake);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine/arena.h"
+#include "engine/level.h"
+#include "engine/profile.h"
+#include "engine/util.h"
+
+// Chunks that can be loaded at once, however big the level is
+#define STREAM_POOL_SIZE 64
+
+// Load requests waiting on the loader, a power of two at least the pool size
+#define STREAM_RING_SIZE 64
+#define STREAM_RING_MASK (STREAM_RING_SIZE - 1)
+
+// Pool slot of a chunk that isn't loaded
+static const u16 StreamSlotNone = 0xFFFF;
+
+typedef enum StreamChunkState {
+  StreamChunkState_Free = 0,
+  // Queued or being decoded on the loader thread, hands off until it's done
+  StreamChunkState_Loading,
+  // Decoded but nothing in it exists in the game
+  StreamChunkState_Loaded,
+  // Its spawns are in the world and its tiles get drawn
+  StreamChunkState_Active,
+} StreamChunkState;
+
+// One chunk's worth of the level, lives in the pool and gets reused
+typedef struct StreamChunk {
+  u16 chunkX;
+  u16 chunkY;
+  atomic_int state;
+  // Tile layer of just this chunk, row major, chunkSize x chunkSize
+  u16 *tiles;
+  LevelSpawn *spawns;
+  u32 firstSpawn;
+  u32 spawnCount;
+} StreamChunk;
+
+typedef void (*StreamChunkCallback)(void *data, StreamChunk *chunk);
+
+// Keeps the chunks near a focus point loaded and the nearest of those active.
+// Chunks within loadRadius are decoded on a thread of their own ahead of
+// time, chunks within activeRadius get activated. Going the other way chunks
+// are deactivated as soon as they leave activeRadius and only dropped once
+// they're past loadRadius + 1, so walking back and forth over a border doesn't
+// thrash. Activating and deactivating only depend on the focus, never on how
+// fast the loader is, so replays stay deterministic.
+typedef struct WorldStream {
+  Level *level;
+  u16 chunkSize;
+  u16 chunksX;
+  u16 chunksY;
+  u32 activeRadius;
+  u32 loadRadius;
+
+  // Pool slot of every chunk in the level, StreamSlotNone if it isn't loaded
+  u16 *slots;
+  StreamChunk pool[STREAM_POOL_SIZE];
+  u16 freeSlots[STREAM_POOL_SIZE];
+  u32 freeCount;
+
+  StreamChunkCallback activate;
+  StreamChunkCallback deactivate;
+  void *callbackData;
+
+  // The owner queues slots at the head, the loader takes them from the tail
+  u16 requests[STREAM_RING_SIZE];
+  atomic_ullong head;
+  atomic_ullong tail;
+  atomic_bool running;
+  SDL_sem *wake;
+  SDL_Thread *loader;
+} WorldStream;
+
+void WorldStreamInit(Arena *arena, WorldStream *stream, Level *level,
+                     u32 activeRadius, u32 loadRadius,
+                     StreamChunkCallback activate,
+                     StreamChunkCallback deactivate, void *callbackData);
+void WorldStreamUpdate(WorldStream *stream, Vec2 focus);
+// For when whatever the callbacks manage was put back to how it was around
+// focus, e.g. restoring a save. Moves the chunks without calling them.
+void WorldStreamReset(WorldStream *stream, Vec2 focus);
+u32 WorldStreamCount(WorldStream *stream, StreamChunkState state);
+void WorldStreamDestroy(WorldStream *stream);
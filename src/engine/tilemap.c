@@ -0,0 +1,187 @@
+#include "engine/tilemap.h"
+
+#include <math.h>
+
+// How far below a box we look for ground
+static const f32 TileMapGroundProbe = 2.0f;
+
+void TileMapInit(Arena *arena, TileMap *map, u16 width, u16 height, u16 tileSize) {
+    map->width = width;
+    map->height = height;
+    map->tileSize = tileSize;
+    map->inverseTileSize = 1.0f / tileSize;
+    map->cells = ArenaPushArrayZero(arena, width * height, u8);
+}
+
+void TileMapInitInPlace(TileMap *map, u16 width, u16 height, u16 tileSize, u8 *cells) {
+    map->width = width;
+    map->height = height;
+    map->tileSize = tileSize;
+    map->inverseTileSize = 1.0f / tileSize;
+    map->cells = cells;
+}
+
+void TileMapSetFlags(TileMap *map, i32 x, i32 y, u8 flags) {
+    if (x < 0 || y < 0 || x >= map->width || y >= map->height) {
+        printf("TileMapSetFlags: cell out of bounds\n");
+        return;
+    }
+
+    map->cells[y * map->width + x] = flags;
+}
+
+u8 TileMapGetFlags(TileMap *map, i32 x, i32 y) {
+    if (x < 0 || y < 0 || x >= map->width || y >= map->height) {
+        return 0;
+    }
+
+    return map->cells[y * map->width + x];
+}
+
+bool TileMapIsSolid(TileMap *map, i32 x, i32 y) {
+    return (TileMapGetFlags(map, x, y) & TileFlag_Solid) != 0;
+}
+
+// Cells a box overlaps, touching edges don't count
+static inline void TileMapGetCellRange(TileMap *map, SDL_FRect box, i32 *minX, i32 *minY, i32 *maxX, i32 *maxY) {
+    *minX = (i32)floorf(box.x * map->inverseTileSize);
+    *minY = (i32)floorf(box.y * map->inverseTileSize);
+    *maxX = (i32)ceilf((box.x + box.w) * map->inverseTileSize) - 1;
+    *maxY = (i32)ceilf((box.y + box.h) * map->inverseTileSize) - 1;
+}
+
+bool TileMapOverlapsSolid(TileMap *map, SDL_FRect box) {
+    i32 minX, minY, maxX, maxY;
+    TileMapGetCellRange(map, box, &minX, &minY, &maxX, &maxY);
+
+    for (i32 y = minY; y <= maxY; y++) {
+        for (i32 x = minX; x <= maxX; x++) {
+            if (TileMapIsSolid(map, x, y)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Cells a region touches, clamped to the map since nothing outside it is solid
+static inline void TileMapGetTouchedRange(TileMap *map, SDL_FRect region, i32 *minX, i32 *minY, i32 *maxX, i32 *maxY) {
+    *minX = MAX((i32)floorf(region.x * map->inverseTileSize), 0);
+    *minY = MAX((i32)floorf(region.y * map->inverseTileSize), 0);
+    *maxX = MIN((i32)floorf((region.x + region.w) * map->inverseTileSize), map->width - 1);
+    *maxY = MIN((i32)floorf((region.y + region.h) * map->inverseTileSize), map->height - 1);
+}
+
+u32 TileMapCountCells(TileMap *map, SDL_FRect region) {
+    i32 minX, minY, maxX, maxY;
+    TileMapGetTouchedRange(map, region, &minX, &minY, &maxX, &maxY);
+    if (maxX < minX || maxY < minY) {
+        return 0;
+    }
+
+    return (u32)(maxX - minX + 1) * (u32)(maxY - minY + 1);
+}
+
+u32 TileMapGatherSolids(TileMap *map, SDL_FRect region, SDL_FRect *boxes, u32 maxBoxes) {
+    // Touching cells are included, a sweep starting flush against a tile still needs it
+    i32 minX, minY, maxX, maxY;
+    TileMapGetTouchedRange(map, region, &minX, &minY, &maxX, &maxY);
+
+    u32 count = 0;
+    for (i32 y = minY; y <= maxY; y++) {
+        for (i32 x = minX; x <= maxX; x++) {
+            if (!TileMapIsSolid(map, x, y)) {
+                continue;
+            }
+
+            // Only when boxes wasn't sized with TileMapCountCells
+            if (count == maxBoxes) {
+                return count;
+            }
+
+            boxes[count++] = (SDL_FRect){x * map->tileSize, y * map->tileSize, map->tileSize, map->tileSize};
+        }
+    }
+
+    return count;
+}
+
+void TileMapMove(TileMap *map, Arena *frameArena, CollisionMover *movers, u32 moverCount) {
+    for (u32 i = 0; i < moverCount; i++) {
+        CollisionMover *mover = &movers[i];
+
+        // NOTE(SeedyROM): Room for every cell the whole move could touch, so a long sweep can't drop the
+        // tile it would have hit and tunnel through it.
+        SDL_FRect region = CollisionGetSweptBounds(mover->box, mover->delta);
+        tempMemoryBlock(frameArena) {
+            u32 cellCount = TileMapCountCells(map, region);
+            SDL_FRect *solids = ArenaPushArray(frameArena, cellCount, SDL_FRect);
+            u32 solidCount = TileMapGatherSolids(map, region, solids, cellCount);
+
+            CollisionMoveAndSlide(mover, solids, solidCount);
+        }
+    }
+}
+
+bool TileMapIsGrounded(TileMap *map, SDL_FRect box) {
+    SDL_FRect groundCheck = {box.x, box.y + box.h, box.w, TileMapGroundProbe};
+    return TileMapOverlapsSolid(map, groundCheck);
+}
+
+bool TileMapRaycast(TileMap *map, Vec2 origin, Vec2 direction, f32 maxDistance, TileMapHit *hit) {
+    f32 length = sqrtf(direction.x * direction.x + direction.y * direction.y);
+    if (length == 0) {
+        return false;
+    }
+    direction.x /= length;
+    direction.y /= length;
+
+    i32 cellX = (i32)floorf(origin.x * map->inverseTileSize);
+    i32 cellY = (i32)floorf(origin.y * map->inverseTileSize);
+
+    // DDA: step into whichever cell boundary is closer along the ray
+    i32 stepX = direction.x > 0 ? 1 : -1;
+    i32 stepY = direction.y > 0 ? 1 : -1;
+    f32 deltaX = direction.x != 0 ? fabsf(map->tileSize / direction.x) : INFINITY;
+    f32 deltaY = direction.y != 0 ? fabsf(map->tileSize / direction.y) : INFINITY;
+
+    f32 nextBoundaryX = (cellX + (stepX > 0 ? 1 : 0)) * map->tileSize;
+    f32 nextBoundaryY = (cellY + (stepY > 0 ? 1 : 0)) * map->tileSize;
+    f32 travelX = direction.x != 0 ? (nextBoundaryX - origin.x) / direction.x : INFINITY;
+    f32 travelY = direction.y != 0 ? (nextBoundaryY - origin.y) / direction.y : INFINITY;
+
+    f32 distance = 0;
+    Vec2 normal = {0, 0};
+    while (distance <= maxDistance) {
+        if (TileMapIsSolid(map, cellX, cellY)) {
+            if (hit != NULL) {
+                hit->cellX = cellX;
+                hit->cellY = cellY;
+                hit->distance = distance;
+                hit->normal = normal;
+            }
+            return true;
+        }
+
+        if (travelX < travelY) {
+            distance = travelX;
+            travelX += deltaX;
+            cellX += stepX;
+            normal = (Vec2){-stepX, 0};
+        } else {
+            distance = travelY;
+            travelY += deltaY;
+            cellY += stepY;
+            normal = (Vec2){0, -stepY};
+        }
+
+        // Stop once the ray has left the map for good
+        if ((cellX < 0 && stepX < 0) || (cellX >= map->width && stepX > 0) ||
+            (cellY < 0 && stepY < 0) || (cellY >= map->height && stepY > 0)) {
+            return false;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#include "engine/arena.h"
+#include "engine/collision.h"
+#include "engine/util.h"
+
+typedef enum TileFlag {
+  TileFlag_Solid = 1 << 0,
+} TileFlag;
+
+// Collision view of a level, one byte of TileFlags per cell in row major order.
+// Everything outside the map is empty.
+typedef struct TileMap {
+  u16 width;
+  u16 height;
+  u16 tileSize;
+  f32 inverseTileSize;
+  u8 *cells;
+} TileMap;
+
+typedef struct TileMapHit {
+  i32 cellX;
+  i32 cellY;
+  f32 distance;
+  Vec2 normal;
+} TileMapHit;
+
+void TileMapInit(Arena *arena, TileMap *map, u16 width, u16 height,
+                 u16 tileSize);
+// Uses cells that live somewhere else, like a mapped level, without copying them
+void TileMapInitInPlace(TileMap *map, u16 width, u16 height, u16 tileSize,
+                        u8 *cells);
+void TileMapSetFlags(TileMap *map, i32 x, i32 y, u8 flags);
+u8 TileMapGetFlags(TileMap *map, i32 x, i32 y);
+bool TileMapIsSolid(TileMap *map, i32 x, i32 y);
+bool TileMapOverlapsSolid(TileMap *map, SDL_FRect box);
+// How many cells a region touches, the most TileMapGatherSolids can find in it
+u32 TileMapCountCells(TileMap *map, SDL_FRect region);
+u32 TileMapGatherSolids(TileMap *map, SDL_FRect region, SDL_FRect *boxes,
+                        u32 maxBoxes);
+void TileMapMove(TileMap *map, Arena *frameArena, CollisionMover *movers,
+                 u32 moverCount);
+bool TileMapIsGrounded(TileMap *map, SDL_FRect box);
+bool TileMapRaycast(TileMap *map, Vec2 origin, Vec2 direction,
+                    f32 maxDistance, TileMapHit *hit);
@@ -0,0 +1,35 @@
+#include "engine/triplebuffer.h"
+
+void TripleBufferInit(TripleBuffer *buffer, void *a, void *b, void *c) {
+    buffer->buffers[0] = a;
+    buffer->buffers[1] = b;
+    buffer->buffers[2] = c;
+    buffer->writeIndex = 0;
+    atomic_init(&buffer->middle, 1);
+    buffer->readIndex = 2;
+}
+
+void *TripleBufferWriteBuffer(TripleBuffer *buffer) {
+    return buffer->buffers[buffer->writeIndex];
+}
+
+void TripleBufferPublish(TripleBuffer *buffer) {
+    // Hand ours over and take whatever was in the middle to write next
+    u32 previous = atomic_exchange_explicit(&buffer->middle, buffer->writeIndex | TRIPLE_BUFFER_FRESH, memory_order_acq_rel);
+    buffer->writeIndex = previous & ~TRIPLE_BUFFER_FRESH;
+}
+
+void *TripleBufferRead(TripleBuffer *buffer, bool *fresh) {
+    bool swapped = false;
+    if (atomic_load_explicit(&buffer->middle, memory_order_relaxed) & TRIPLE_BUFFER_FRESH) {
+        u32 previous = atomic_exchange_explicit(&buffer->middle, buffer->readIndex, memory_order_acq_rel);
+        buffer->readIndex = previous & ~TRIPLE_BUFFER_FRESH;
+        swapped = true;
+    }
+
+    if (fresh != NULL) {
+        *fresh = swapped;
+    }
+
+    return buffer->buffers[buffer->readIndex];
+}
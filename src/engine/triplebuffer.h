@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "engine/util.h"
+
+// Set on the middle slot when the writer has published something the reader hasn't taken yet
+#define TRIPLE_BUFFER_FRESH 0x4
+
+// Lock-free handoff from one writer thread to one reader thread. The writer
+// fills its buffer and swaps it into the middle, the reader swaps the middle
+// out when there's something new. Neither side ever waits on the other, the
+// reader just keeps the last one until a fresher one shows up.
+typedef struct TripleBuffer {
+  void *buffers[3];
+  // Only the writer touches this
+  u32 writeIndex;
+  // Only the reader touches this
+  u32 readIndex;
+  // Index of the buffer in between, or'd with TRIPLE_BUFFER_FRESH
+  atomic_uint middle;
+} TripleBuffer;
+
+void TripleBufferInit(TripleBuffer *buffer, void *a, void *b, void *c);
+void *TripleBufferWriteBuffer(TripleBuffer *buffer);
+void TripleBufferPublish(TripleBuffer *buffer);
+void *TripleBufferRead(TripleBuffer *buffer, bool *fresh);
@@ -1,6 +1,120 @@
 #include "game.h"
 
-int GameInit(Game *game) {
+static const int GameWindowWidth = 1280;
+static const int GameWindowHeight = 720;
+static const int GameWindowScaleFactor = 4;
+
+// Frames to run in headless mode when no limit is given, so automation always terminates
+static const u32 GameHeadlessDefaultFrames = 600;
+
+// Ticks to run in sim-only mode without a limit or a replay, ten minutes of gameplay
+static const u64 GameSimOnlyDefaultTicks = 60 * 60 * 10;
+
+// Built from assets/levels by the levels target, next to the executable
+static const char *GameDefaultLevel = "levels/level_01.capylvl";
+
+// Built from assets/gamecontrollerdb.txt for this platform, next to the executable
+static const char *GameControllerDbPath = "gamecontrollerdb.capypad";
+
+// How far back rewinding can go
+static const u32 GameRewindSeconds = 10;
+
+int GameParseOptions(GameOptions *options, int argc, char *argv[]) {
+    options->headless = false;
+    options->simOnly = false;
+    options->vsync = true;
+    options->frameLimit = 0;
+    options->tickLimit = 0;
+    options->captureDir = NULL;
+    options->tracePath = NULL;
+    options->countersPath = NULL;
+    options->recordPath = NULL;
+    options->replayPath = NULL;
+    options->levelPath = GameDefaultLevel;
+    options->rewindSeconds = GameRewindSeconds;
+    options->rewindCheck = 0;
+    bool rewindGiven = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            options->headless = true;
+        } else if (strcmp(argv[i], "--sim-only") == 0) {
+            options->simOnly = true;
+        } else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            options->tickLimit = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--no-vsync") == 0) {
+            options->vsync = false;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            options->frameLimit = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            options->captureDir = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            options->tracePath = argv[++i];
+        } else if (strcmp(argv[i], "--counters") == 0 && i + 1 < argc) {
+            options->countersPath = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            options->recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            options->replayPath = argv[++i];
+        } else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) {
+            options->levelPath = argv[++i];
+        } else if (strcmp(argv[i], "--rewind") == 0 && i + 1 < argc) {
+            options->rewindSeconds = strtoul(argv[++i], NULL, 10);
+            rewindGiven = true;
+        } else if (strcmp(argv[i], "--rewind-check") == 0 && i + 1 < argc) {
+            options->rewindCheck = strtoul(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            fprintf(stderr, "Usage: %s [--headless] [--sim-only] [--no-vsync] [--frames N] [--ticks N] [--capture DIR] [--trace FILE] [--counters FILE] [--record FILE | --replay FILE] [--level FILE] [--rewind SECONDS] [--rewind-check N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (options->recordPath != NULL && options->replayPath != NULL) {
+        fprintf(stderr, "Can't --record and --replay at the same time\n");
+        return 1;
+    }
+
+    // Nobody holds Backspace in a benchmark, capturing every tick would just be what it measures
+    if (options->simOnly && !rewindGiven && options->rewindCheck == 0) {
+        options->rewindSeconds = 0;
+    }
+
+    if (options->rewindCheck != 0 && (!options->simOnly || options->rewindSeconds == 0)) {
+        fprintf(stderr, "--rewind-check only works with --sim-only and rewinding on\n");
+        return 1;
+    }
+
+    if (options->rewindCheck > options->rewindSeconds * GameTickRate) {
+        fprintf(stderr, "--rewind-check can't go back further than --rewind keeps\n");
+        return 1;
+    }
+
+    if (options->headless && options->frameLimit == 0) {
+        options->frameLimit = GameHeadlessDefaultFrames;
+    }
+
+    // A replay ends the run by itself
+    if (options->simOnly && options->tickLimit == 0 && options->replayPath == NULL) {
+        options->tickLimit = GameSimOnlyDefaultTicks;
+    }
+
+    return 0;
+}
+
+void GameRegisterCounters(void) {
+    CountersRegister(GameCounter_Entities, "entities", CounterKind_Gauge);
+    CountersRegister(GameCounter_CoinBoxesTested, "coin_boxes_tested", CounterKind_Counter);
+    CountersRegister(GameCounter_CoinBoxHits, "coin_box_hits", CounterKind_Counter);
+    CountersRegister(GameCounter_ActorPairs, "actor_pairs", CounterKind_Counter);
+    CountersRegister(GameCounter_GlobalArenaBytes, "global_arena_bytes", CounterKind_Gauge);
+    CountersRegister(GameCounter_FrameArenaBytes, "frame_arena_bytes", CounterKind_Gauge);
+    CountersRegister(GameCounter_ChunksLoaded, "chunks_loaded", CounterKind_Gauge);
+    CountersRegister(GameCounter_ChunksActive, "chunks_active", CounterKind_Gauge);
+    CountersRegister(GameCounter_InputLatency, "input_latency_us", CounterKind_Gauge);
+}
+
+int GameInit(Game *game, bool vsync) {
     // Initialize SDL
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_GAMECONTROLLER) != 0) {
         fprintf(stderr, "SDL_Init Error: %s\n", SDL_GetError());
@@ -11,7 +125,7 @@ int GameInit(Game *game) {
     SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
 
     // Create a window
-    SDL_Window *window = SDL_CreateWindow("Capy Quest", 100, 100, 1280, 720, SDL_WINDOW_SHOWN | SDL_WINDOW_ALLOW_HIGHDPI);
+    SDL_Window *window = SDL_CreateWindow("Capy Quest", 100, 100, GameWindowWidth, GameWindowHeight, SDL_WINDOW_SHOWN | SDL_WINDOW_ALLOW_HIGHDPI);
     if (window == NULL) {
         fprintf(stderr, "SDL_CreateWindow Error: %s\n", SDL_GetError());
         return 1;
@@ -19,69 +133,169 @@ int GameInit(Game *game) {
 
     // Create a renderer
     SDL_SetHint(SDL_HINT_RENDER_BATCHING, "1");
-    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    // The simulation runs on its own clock, so presenting can be vsynced or uncapped
+    Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+    if (vsync) {
+        rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+    }
+    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, rendererFlags);
     if (renderer == NULL) {
         fprintf(stderr, "SDL_CreateRenderer Error: %s\n", SDL_GetError());
         return 1;
     }
 
-    // Window scale factor
-    int windowScaleFactor = 4;
-
     // Get the window size
     int windowRealWidth = 0;
     int windowRealHeight = 0;
     SDL_GetWindowSize(window, &windowRealWidth, &windowRealHeight);
 
     // Get the scaled window size
-    game->windowWidth = windowRealWidth / windowScaleFactor;
-    game->windowHeight = windowRealHeight / windowScaleFactor;
+    game->windowWidth = windowRealWidth / GameWindowScaleFactor;
+    game->windowHeight = windowRealHeight / GameWindowScaleFactor;
 
     // Set the logical size of the renderer
     SDL_RenderSetLogicalSize(renderer, game->windowWidth, game->windowHeight);
 
     game->window = window;
     game->renderer = renderer;
+    game->surface = NULL;
+    game->headless = false;
     game->controller = NULL;
+    game->controllerDb.base = NULL;
 
     return 0;
 }
 
-int GameLoadDefaultController(Game *game) {
-    SDL_GameController *controller = game->controller;
+int GameInitHeadless(Game *game) {
+    // No display needed, the dummy driver never touches a window system
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        fprintf(stderr, "SDL_Init Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    // Pixel Art Hint
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+
+    // Render straight into a surface at the logical size, no scaling and no vsync
+    game->windowWidth = GameWindowWidth / GameWindowScaleFactor;
+    game->windowHeight = GameWindowHeight / GameWindowScaleFactor;
 
-    // Load the joystick mapping
-    if (SDL_GameControllerAddMappingsFromFile("../assets/gamecontrollerdb.txt") == -1) {
-        fprintf(stderr, "SDL_GameControllerAddMappingsFromFile Error: %s\n", SDL_GetError());
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, game->windowWidth, game->windowHeight, 32, SDL_PIXELFORMAT_ABGR8888);
+    if (surface == NULL) {
+        fprintf(stderr, "SDL_CreateRGBSurfaceWithFormat Error: %s\n", SDL_GetError());
         return 1;
     }
-    // Print how many joysticks are connected
-    printf("Number of joysticks connected: %d\n", SDL_NumJoysticks());
-    if (SDL_NumJoysticks() > 0) {
-        controller = SDL_GameControllerOpen(0);
-        if (controller == NULL) {
-            fprintf(stderr, "SDL_JoystickOpen Error: %s\n", SDL_GetError());
-            return 1;
-        }
+
+    // The software renderer is deterministic across machines, so frames can be hashed
+    SDL_Renderer *renderer = SDL_CreateSoftwareRenderer(surface);
+    if (renderer == NULL) {
+        fprintf(stderr, "SDL_CreateSoftwareRenderer Error: %s\n", SDL_GetError());
+        return 1;
     }
 
-    if (controller != NULL) {
-        // Print the joystick name
-        printf("Controller name: %s\n", SDL_GameControllerName(controller));
+    game->window = NULL;
+    game->renderer = renderer;
+    game->surface = surface;
+    game->headless = true;
+    game->controller = NULL;
+    game->controllerDb.base = NULL;
+
+    return 0;
+}
+
+int GameInitSimOnly(Game *game) {
+    // NOTE(SeedyROM): No subsystems at all, the simulation only needs the performance counter.
+    if (SDL_Init(0) != 0) {
+        fprintf(stderr, "SDL_Init Error: %s\n", SDL_GetError());
         return 1;
     }
 
+    game->windowWidth = GameWindowWidth / GameWindowScaleFactor;
+    game->windowHeight = GameWindowHeight / GameWindowScaleFactor;
+    game->window = NULL;
+    game->renderer = NULL;
+    game->surface = NULL;
+    game->headless = true;
+    game->controller = NULL;
+    game->controllerDb.base = NULL;
+
     return 0;
 }
 
+int GameLoadDefaultController(Game *game) {
+    // Only the mappings for devices that are actually plugged in get handed to SDL
+    u64 start = SDL_GetPerformanceCounter();
+    if (ControllerDbLoad(&game->controllerDb, GameControllerDbPath) != 0) {
+        return 1;
+    }
+
+    int joystickCount = SDL_NumJoysticks();
+    for (int i = 0; i < joystickCount; i++) {
+        ControllerDbRegister(&game->controllerDb, i);
+    }
+    printf("Loaded %u controller mappings for %d joysticks in %.3fms\n", game->controllerDb.header->entryCount, joystickCount,
+           (f64)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency());
+
+    // Open the first one SDL knows how to use
+    for (int i = 0; i < joystickCount && game->controller == NULL; i++) {
+        GameOpenController(game, i);
+    }
+
+    return 0;
+}
+
+// The game reads one controller, anything plugged in while it's open is left alone. True if it opened
+bool GameOpenController(Game *game, int deviceIndex) {
+    if (game->controller != NULL || !SDL_IsGameController(deviceIndex)) {
+        return false;
+    }
+
+    game->controller = SDL_GameControllerOpen(deviceIndex);
+    if (game->controller == NULL) {
+        fprintf(stderr, "SDL_GameControllerOpen Error: %s\n", SDL_GetError());
+        return false;
+    }
+
+    // Print the joystick name
+    printf("Controller name: %s\n", SDL_GameControllerName(game->controller));
+    return true;
+}
+
+// Only closes the open controller if it's the one that went, then takes the next one still plugged in.
+// True if it closed
+bool GameCloseController(Game *game, SDL_JoystickID instance) {
+    if (game->controller == NULL || SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(game->controller)) != instance) {
+        return false;
+    }
+
+    printf("Controller disconnected\n");
+    SDL_GameControllerClose(game->controller);
+    game->controller = NULL;
+
+    for (int i = 0; i < SDL_NumJoysticks() && game->controller == NULL; i++) {
+        GameOpenController(game, i);
+    }
+    return true;
+}
+
 void GameShutdown(Game *game) {
     // Close the controller
     if (game->controller != NULL) {
         SDL_GameControllerClose(game->controller);
+        game->controller = NULL;
     }
+    ControllerDbUnload(&game->controllerDb);
 
     // Shutdown SDL
-    SDL_DestroyRenderer(game->renderer);
-    SDL_DestroyWindow(game->window);
+    if (game->renderer != NULL) {
+        SDL_DestroyRenderer(game->renderer);
+    }
+    if (game->window != NULL) {
+        SDL_DestroyWindow(game->window);
+    }
+    if (game->surface != NULL) {
+        SDL_FreeSurface(game->surface);
+    }
     SDL_Quit();
 }
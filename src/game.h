@@ -4,23 +4,62 @@
 
 #include "engine/engine.h"
 #include "game/behaviours.h"
+#include "game/components.h"
 #include "game/entities.h"
+#include "game/simulation.h"
+#include "game/systems.h"
 
-typedef struct Camera {
-    Vec2 position;
-    Vec2 scale;
-    f32 rotation;
-} Camera;
+// Gameplay values (gravity, speeds, animation timers) are tuned per tick at this rate
+static const u32 GameTickRate = 60;
+
+// Counters the game keeps on top of the engine's
+typedef enum GameCounter {
+    GameCounter_Entities = EngineCounter_Count,
+    GameCounter_CoinBoxesTested,
+    GameCounter_CoinBoxHits,
+    GameCounter_ActorPairs,
+    GameCounter_GlobalArenaBytes,
+    GameCounter_FrameArenaBytes,
+    GameCounter_ChunksLoaded,
+    GameCounter_ChunksActive,
+    GameCounter_InputLatency,
+} GameCounter;
+
+typedef struct GameOptions {
+    bool headless;
+    bool simOnly;
+    bool vsync;
+    u32 frameLimit;
+    u64 tickLimit;
+    const char *captureDir;
+    const char *tracePath;
+    const char *countersPath;
+    const char *recordPath;
+    const char *replayPath;
+    const char *levelPath;
+    u32 rewindSeconds;
+    u32 rewindCheck;
+} GameOptions;
 
 typedef struct Game {
     SDL_Window *window;
     SDL_Renderer *renderer;
+    SDL_Surface *surface;
+    bool headless;
     u16 windowWidth;
     u16 windowHeight;
     SDL_GameController *controller;
+    // Mappings for this platform, registered as devices show up
+    ControllerDb controllerDb;
     Camera camera;
 } Game;
 
-int GameInit(Game *game);
+int GameParseOptions(GameOptions *options, int argc, char *argv[]);
+void GameRegisterCounters(void);
+int GameInit(Game *game, bool vsync);
+int GameInitHeadless(Game *game);
+int GameInitSimOnly(Game *game);
 int GameLoadDefaultController(Game *game);
+bool GameOpenController(Game *game, int deviceIndex);
+bool GameCloseController(Game *game, SDL_JoystickID instance);
 void GameShutdown(Game *game);
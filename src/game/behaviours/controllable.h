@@ -2,6 +2,7 @@
 
 #include <SDL2/SDL.h>
 
+#include "engine/input.h"
 #include "engine/util.h"
 
 typedef struct Controllable {
@@ -9,13 +10,11 @@ typedef struct Controllable {
   Vec2 *velocity;
   bool *grounded;
 
-  void (*update)(struct Controllable *controllable,
-                 SDL_GameController *controller);
+  void (*update)(struct Controllable *controllable, InputActions *actions);
 } Controllable;
 
 void ControllableInit(Controllable *controllable, Vec2 *position,
                       Vec2 *velocity, bool *grounded,
                       void (*update)(Controllable *controllable,
-                                     SDL_GameController *controller));
-void ControllableUpdate(Controllable *controllable,
-                        SDL_GameController *controller);
+                                     InputActions *actions));
+void ControllableUpdate(Controllable *controllable, InputActions *actions);
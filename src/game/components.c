@@ -0,0 +1,13 @@
+#include "components.h"
+
+void ComponentsRegister(EcsWorld *world) {
+    EcsRegisterComponent(world, Component_Position, sizeof(Vec2));
+    EcsRegisterComponent(world, Component_Sprite, sizeof(TextureAtlasFrames));
+    EcsRegisterComponent(world, Component_Animation, sizeof(Animation));
+    EcsRegisterComponent(world, Component_Coin, sizeof(CoinState));
+    EcsRegisterComponent(world, Component_Spawn, sizeof(u32));
+}
+
+usize ComponentsRowSize(void) {
+    return sizeof(Vec2) + sizeof(TextureAtlasFrames) + sizeof(Animation) + sizeof(CoinState) + sizeof(u32);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "engine/ecs.h"
+#include "engine/gfx.h"
+#include "engine/util.h"
+
+typedef enum Component {
+  Component_Position = 0,
+  Component_Sprite = 1,
+  Component_Animation = 2,
+  Component_Coin = 3,
+  Component_Spawn = 4,
+  Component_Count,
+} Component;
+
+// Component_Position is a Vec2, Component_Sprite is TextureAtlasFrames
+// Component_Spawn is the u32 index of the level spawn an entity came from
+
+typedef struct Animation {
+  u32 time;
+  u16 frameDuration;
+  u16 currentFrame;
+} Animation;
+
+typedef struct CoinState {
+  u16 collectedTime;
+  bool collected;
+} CoinState;
+
+void ComponentsRegister(EcsWorld *world);
+// Every component at once, no archetype's row is wider
+usize ComponentsRowSize(void);
@@ -2,4 +2,3 @@
 
 #include "entities/coin.h"
 #include "entities/player.h"
-#include "entities/wall.h"
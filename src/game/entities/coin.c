@@ -1,38 +1,52 @@
 #include "coin.h"
 
-void CoinInit(Coin *coin, TextureAtlas *atlas) {
-    coin->collected = false;
-    coin->atlas = atlas;
-    coin->time = 0;
-    coin->collectedTime = 0;
-    coin->frameDuration = 10;
-    coin->currentFrame = 0;
-    coin->delete = false;
-
-    SpriteFromAtlas(&coin->sprite, atlas, &STR("coin"));
+static const EcsComponentMask CoinComponents =
+    EcsComponentBit(Component_Position) | EcsComponentBit(Component_Sprite) |
+    EcsComponentBit(Component_Animation) | EcsComponentBit(Component_Coin);
+
+EcsEntity CoinSpawn(EcsCommandBuffer *commands, TextureAtlas *atlas, Vec2 position) {
+    TextureAtlasFrames frames = TextureAtlasIndicesGetFrames(atlas, &STR("coin"));
+    Animation animation = {.frameDuration = 10};
+
+    EcsEntity coin = EcsCommandSpawn(commands, CoinComponents);
+    EcsCommandSet(commands, coin, Component_Position, &position);
+    EcsCommandSet(commands, coin, Component_Sprite, &frames);
+    EcsCommandSet(commands, coin, Component_Animation, &animation);
+
+    return coin;
 }
 
-void CoinCollect(Coin *coin) {
-    if (coin->collected)
+void CoinCollect(EcsWorld *world, EcsEntity coin, TextureAtlas *atlas) {
+    CoinState *state = EcsGetComponent(world, coin, CoinState, Component_Coin);
+    if (state == NULL || state->collected)
         return;
 
-    coin->time = 0;
-    coin->currentFrame = 0;
-    coin->collected = true;
-    coin->frameDuration = 3;
+    state->collected = true;
+
+    Animation *animation = EcsGetComponent(world, coin, Animation, Component_Animation);
+    animation->time = 0;
+    animation->currentFrame = 0;
+    animation->frameDuration = 3;
 
-    SpriteChange(&coin->sprite, &STR("coin_collected"));
+    *EcsGetComponent(world, coin, TextureAtlasFrames, Component_Sprite) = TextureAtlasIndicesGetFrames(atlas, &STR("coin_collected"));
 }
 
-void CoinUpdate(Coin *coin) {
-    if (coin->collected) {
-        coin->collectedTime += 1;
-        if (coin->collectedTime > 18) {
-            coin->delete = true;
+void CoinUpdate(EcsWorld *world, EcsCommandBuffer *commands) {
+    EcsQuery query = EcsQueryBegin(world, EcsComponentBit(Component_Coin));
+    while (EcsQueryNext(&query)) {
+        CoinState *states = EcsQueryColumnOf(&query, CoinState, Component_Coin);
+        EcsEntity *entities = EcsQueryEntities(&query);
+
+        for (u32 i = 0; i < query.count; i++) {
+            CoinState *state = &states[i];
+            if (!state->collected) {
+                continue;
+            }
+
+            state->collectedTime += 1;
+            if (state->collectedTime > 18) {
+                EcsCommandDestroy(commands, entities[i]);
+            }
         }
     }
-    if (coin->time % coin->frameDuration == 0) {
-        coin->currentFrame = (coin->currentFrame + 1) % coin->sprite.frames.len;
-    }
-    coin->time += 1;
 }
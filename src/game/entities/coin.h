@@ -3,21 +3,14 @@
 #include <SDL2/SDL.h>
 #include <stdbool.h>
 
+#include "engine/commands.h"
+#include "engine/ecs.h"
 #include "engine/gfx.h"
 #include "engine/util.h"
+#include "game/components.h"
 
-typedef struct Coin {
-  TextureAtlas *atlas;
-  bool collected;
-  Sprite sprite;
-  usize time;
-  usize collectedTime;
-  u16 frameDuration;
-  u16 currentFrame;
-  bool delete;
-} Coin;
+EcsEntity CoinSpawn(EcsCommandBuffer *commands, TextureAtlas *atlas,
+                    Vec2 position);
+void CoinCollect(EcsWorld *world, EcsEntity coin, TextureAtlas *atlas);
 
-void CoinInit(Coin *coin, TextureAtlas *atlas);
-void CoinCollect(Coin *coin);
-
-void CoinUpdate(Coin *coin);
+void CoinUpdate(EcsWorld *world, EcsCommandBuffer *commands);
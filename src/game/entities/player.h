@@ -8,10 +8,12 @@
 
 typedef struct Player {
   Sprite sprite;
+  // Where the last tick left the player, drawing blends from here
+  Vec2 previousPos;
   Vec2 velocity;
   bool grounded;
 } Player;
 
 void PlayerInit(Player *player, Sprite *sprite);
-void PlayerControl(Controllable *controllable, SDL_GameController *controller);
+void PlayerControl(Controllable *controllable, InputActions *actions);
 void PlayerUpdate(Player *player, f32 gravity);
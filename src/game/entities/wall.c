@@ -1,5 +0,0 @@
-#include "wall.h"
-
-void WallInit(Wall *wall, Vec2 position) {
-    wall->position = position;
-}
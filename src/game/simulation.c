@@ -0,0 +1,842 @@
+#include "game/simulation.h"
+
+#include "game.h"
+
+static const char *SimSystemNames[SimSystem_Count] = {
+    "Stream",
+    "Player",
+    "World",
+    "ActorCollisions",
+    "TileCollisions",
+    "Commands",
+    "Rewind",
+};
+
+static f32 gravity = 0.098f / 1.4f;
+
+bool IsCollision(Sprite *a, u16 aFrame, Sprite *b, u16 bFrame) {
+    SDL_Rect aRect = a->frames.ptr[aFrame];
+    SDL_Rect bRect = b->frames.ptr[bFrame];
+
+    // Sprites are drawn from their top left corner, so collide from there too
+    aRect.x = a->pos.x;
+    aRect.y = a->pos.y;
+    bRect.x = b->pos.x;
+    bRect.y = b->pos.y;
+
+    if (!SDL_HasIntersection(&aRect, &bRect)) {
+        return false;
+    }
+
+    // The boxes touch, check the actual pixels
+    return CollisionMaskOverlap(SpriteGetMask(a, aFrame), aRect.x, aRect.y, a->flipX,
+                                SpriteGetMask(b, bFrame), bRect.x, bRect.y, b->flipX);
+}
+
+// Moving bodies that bump into each other, only the player for now but NPCs will join
+void HandleActorCollisions(SweepAndPrune *actors, Sprite **actorSprites, TileMap *tileMap, Arena *frameArena) {
+    // Refresh the boxes of everything that moved
+    for (u32 i = 0; i < actors->bodyCapacity; i++) {
+        if (!actors->active[i]) {
+            continue;
+        }
+
+        Sprite *sprite = actorSprites[i];
+        SDL_Rect frame = sprite->frames.ptr[sprite->currentFrame];
+        SweepAndPruneUpdate(actors, i, (SDL_FRect){sprite->pos.x, sprite->pos.y, frame.w, frame.h});
+    }
+
+    AABBPair *pairs = NULL;
+    u32 pairCount = SweepAndPruneFindPairs(actors, frameArena, &pairs);
+    CountersAdd(GameCounter_ActorPairs, pairCount);
+    if (pairCount == 0) {
+        return;
+    }
+
+    // Push overlapping actors apart along the shallower axis
+    Vec2 *pushes = ArenaPushArrayZero(frameArena, actors->bodyCapacity, Vec2);
+    for (u32 i = 0; i < pairCount; i++) {
+        SDL_FRect *a = &actors->boxes[pairs[i].a];
+        SDL_FRect *b = &actors->boxes[pairs[i].b];
+
+        f32 overlapX = MIN(a->x + a->w, b->x + b->w) - MAX(a->x, b->x);
+        f32 overlapY = MIN(a->y + a->h, b->y + b->h) - MAX(a->y, b->y);
+        if (overlapX < overlapY) {
+            f32 push = (a->x < b->x ? -overlapX : overlapX) / 2;
+            pushes[pairs[i].a].x += push;
+            pushes[pairs[i].b].x -= push;
+        } else {
+            f32 push = (a->y < b->y ? -overlapY : overlapY) / 2;
+            pushes[pairs[i].a].y += push;
+            pushes[pairs[i].b].y -= push;
+        }
+    }
+
+    // NOTE(SeedyROM): The pushes get swept through the tiles like any other move, otherwise
+    // one could shove an actor into a wall and the tile sweep would start from inside it.
+    u32 *bodies = ArenaPushArray(frameArena, actors->bodyCapacity, u32);
+    CollisionMover *movers = ArenaPushArray(frameArena, actors->bodyCapacity, CollisionMover);
+    u32 moverCount = 0;
+    for (u32 i = 0; i < actors->bodyCapacity; i++) {
+        if (!actors->active[i] || (pushes[i].x == 0 && pushes[i].y == 0)) {
+            continue;
+        }
+
+        bodies[moverCount] = i;
+        movers[moverCount] = (CollisionMover){.box = actors->boxes[i], .delta = pushes[i]};
+        moverCount++;
+    }
+    TileMapMove(tileMap, frameArena, movers, moverCount);
+
+    for (u32 i = 0; i < moverCount; i++) {
+        Sprite *sprite = actorSprites[bodies[i]];
+        sprite->pos.x = movers[i].box.x;
+        sprite->pos.y = movers[i].box.y;
+    }
+}
+
+static int SimulationSpawnCompare(const void *a, const void *b) {
+    u32 left = *(const u32 *)a;
+    u32 right = *(const u32 *)b;
+    return left < right ? -1 : left > right;
+}
+
+// Add this function to handle all collision checks and responses
+void HandleCollisions(Player *player, TileMap *tileMap, EcsWorld *world, SpatialHash *coinHash, EcsEntity *coinEntities, TextureAtlas *atlas, Arena *frameArena) {
+    SDL_Rect playerFrame = player->sprite.frames.ptr[player->sprite.currentFrame];
+
+    // Sweep the player through the tiles by its velocity
+    CollisionMover playerMover = {
+        .box = {player->sprite.pos.x, player->sprite.pos.y, playerFrame.w, playerFrame.h},
+        .delta = player->velocity};
+    TileMapMove(tileMap, frameArena, &playerMover, 1);
+
+    SDL_FRect playerBox = playerMover.box;
+    player->sprite.pos.x = playerBox.x;
+    player->sprite.pos.y = playerBox.y;
+
+    // Stop along whichever axis we ran into something
+    if (playerMover.normal.x != 0) {
+        player->velocity.x = 0;
+    }
+    if (playerMover.normal.y != 0) {
+        player->velocity.y = 0;
+    }
+
+    // Check grounded state after all collisions are resolved
+    player->grounded = TileMapIsGrounded(tileMap, playerBox);
+
+    // Only the coins in the cells around the player, in spawn order so they're collected the same way
+    // however the hash was built
+    u32 *nearby = ArenaPushArray(frameArena, coinHash->idCapacity, u32);
+    u32 nearbyCount = SpatialHashQuery(coinHash, playerBox, nearby, coinHash->idCapacity);
+    qsort(nearby, nearbyCount, sizeof(u32), SimulationSpawnCompare);
+
+    u16 *coinFrames = ArenaPushArray(frameArena, nearbyCount, u16);
+    Sprite coinSprite = {.atlas = atlas, .scale = {1, 1}};
+
+    AABBBatch coinBoxes;
+    AABBBatchInit(frameArena, &coinBoxes, nearbyCount);
+    for (u32 i = 0; i < nearbyCount; i++) {
+        EcsEntity coin = coinEntities[nearby[i]];
+        Vec2 *position = EcsGetComponent(world, coin, Vec2, Component_Position);
+        TextureAtlasFrames *frames = EcsGetComponent(world, coin, TextureAtlasFrames, Component_Sprite);
+        Animation *animation = EcsGetComponent(world, coin, Animation, Component_Animation);
+
+        SDL_Rect coinRect = frames->ptr[animation->currentFrame];
+        coinFrames[i] = animation->currentFrame;
+        AABBBatchPush(&coinBoxes, (SDL_FRect){position->x, position->y, coinRect.w, coinRect.h});
+    }
+
+    // Test the player against the nearby coin boxes at once, then check the pixels of the hits
+    u32 hitCount = AABBBatchOverlapBox(&coinBoxes, playerBox);
+    CountersAdd(GameCounter_CoinBoxesTested, coinBoxes.count);
+    CountersAdd(GameCounter_CoinBoxHits, hitCount);
+    for (u32 i = 0; i < hitCount; i++) {
+        u32 hit = coinBoxes.hits[i];
+        EcsEntity coin = coinEntities[nearby[hit]];
+        coinSprite.frames = *EcsGetComponent(world, coin, TextureAtlasFrames, Component_Sprite);
+        coinSprite.pos = *EcsGetComponent(world, coin, Vec2, Component_Position);
+        if (IsCollision(&player->sprite, player->sprite.currentFrame, &coinSprite, coinFrames[hit])) {
+            CoinCollect(world, coin, atlas);
+            SpatialHashRemove(coinHash, nearby[hit]);
+        }
+    }
+}
+
+static inline bool SimulationSpawnConsumed(Simulation *sim, u32 index) {
+    return (sim->state->consumedSpawns[index / 8] >> (index % 8)) & 1;
+}
+
+static inline void SimulationSpawnSetConsumed(Simulation *sim, u32 index, bool consumed) {
+    if (consumed) {
+        sim->state->consumedSpawns[index / 8] |= (u8)(1 << (index % 8));
+    } else {
+        sim->state->consumedSpawns[index / 8] &= (u8)~(1 << (index % 8));
+    }
+}
+
+// Spawn whatever a chunk asks for as it comes into range
+static void SimulationActivateChunk(void *data, StreamChunk *chunk) {
+    Simulation *sim = data;
+    u16 tileSize = sim->level->header->tileSize;
+    sim->coinHashDirty = true;
+
+    for (u32 i = 0; i < chunk->spawnCount; i++) {
+        u32 index = chunk->firstSpawn + i;
+        if (SimulationSpawnConsumed(sim, index)) {
+            continue;
+        }
+
+        LevelSpawn *spawn = &chunk->spawns[i];
+        Vec2 cell = {spawn->x * tileSize, spawn->y * tileSize};
+
+        switch (spawn->kind) {
+            case LevelSpawn_Coin: {
+                // Coins sit in the middle of their tile
+                EcsEntity coin = CoinSpawn(&sim->commands, sim->atlas, (Vec2){cell.x + 4, cell.y + 4});
+                EcsCommandAdd(&sim->commands, coin, Component_Spawn);
+                EcsCommandSet(&sim->commands, coin, Component_Spawn, &index);
+            } break;
+
+            case LevelSpawn_Player: {
+                // Placed once at init, never respawned
+            } break;
+
+            default: {
+                printf("Unknown level spawn kind: %u\n", spawn->kind);
+            } break;
+        }
+    }
+}
+
+// Despawn a chunk's entities as it goes out of range, remembering which ones are gone for good
+static void SimulationDeactivateChunk(void *data, StreamChunk *chunk) {
+    Simulation *sim = data;
+    sim->coinHashDirty = true;
+
+    // Anything that isn't still around untouched stays consumed
+    for (u32 i = 0; i < chunk->spawnCount; i++) {
+        SimulationSpawnSetConsumed(sim, chunk->firstSpawn + i, true);
+    }
+
+    u32 firstSpawn = chunk->firstSpawn;
+    u32 lastSpawn = chunk->firstSpawn + chunk->spawnCount;
+    EcsQuery query = EcsQueryBegin(&sim->state->world, EcsComponentBit(Component_Spawn));
+    while (EcsQueryNext(&query)) {
+        u32 *spawns = EcsQueryColumnOf(&query, u32, Component_Spawn);
+        CoinState *coins = EcsQueryColumnOf(&query, CoinState, Component_Coin);
+        EcsEntity *entities = EcsQueryEntities(&query);
+
+        for (u32 i = 0; i < query.count; i++) {
+            if (spawns[i] < firstSpawn || spawns[i] >= lastSpawn) {
+                continue;
+            }
+
+            if (coins == NULL || !coins[i].collected) {
+                SimulationSpawnSetConsumed(sim, spawns[i], false);
+            }
+            EcsCommandDestroy(&sim->commands, entities[i]);
+        }
+    }
+}
+
+// Puts every coin that hasn't been picked up in the hash, the world is the only thing it trusts
+static void SimulationRebuildCoinHash(Simulation *sim) {
+    SpatialHashClear(&sim->coinHash);
+
+    EcsWorld *world = &sim->state->world;
+    EcsQuery query = EcsQueryBegin(world, EcsComponentBit(Component_Position) | EcsComponentBit(Component_Coin) | EcsComponentBit(Component_Spawn));
+    while (EcsQueryNext(&query)) {
+        Vec2 *positions = EcsQueryColumnOf(&query, Vec2, Component_Position);
+        CoinState *states = EcsQueryColumnOf(&query, CoinState, Component_Coin);
+        u32 *spawns = EcsQueryColumnOf(&query, u32, Component_Spawn);
+        EcsEntity *entities = EcsQueryEntities(&query);
+
+        for (u32 i = 0; i < query.count; i++) {
+            if (states[i].collected) {
+                continue;
+            }
+
+            SpatialHashInsert(&sim->coinHash, spawns[i], (SDL_FRect){positions[i].x, positions[i].y, sim->coinSize.x, sim->coinSize.y});
+            sim->coinEntities[spawns[i]] = entities[i];
+        }
+    }
+
+    sim->coinHashDirty = false;
+}
+
+// Chunks next to the player are live, one more ring out gets decoded ahead of time
+static const u32 SimulationActiveRadius = 1;
+static const u32 SimulationLoadRadius = 2;
+
+// Coins spawn without Spawn and move archetype when it's added, the rest is room for another kind
+static const u32 SimulationArchetypeCount = 4;
+
+// Actors, the player is body 0
+static const u32 SimulationActorCapacity = 64;
+
+// Gameplay state only, the level and the atlas live elsewhere and never change. Only active chunks have
+// entities, so the busiest window of them bounds the world and it can't run out partway through a level
+static usize SimulationStateMemory(Level *level, u32 *entityCapacity) {
+    LevelHeader *header = level->header;
+    u32 busiestChunk = 0;
+    for (u32 i = 0; i < (u32)header->chunksX * header->chunksY; i++) {
+        busiestChunk = MAX(busiestChunk, level->chunks[i].spawnCount);
+    }
+
+    // NOTE(SeedyROM): Twice the window, a load or a rewind can swap every active chunk for
+    // another in one update and the new spawns can land before the old ones are destroyed
+    u32 window = 2 * SimulationActiveRadius + 1;
+    *entityCapacity = MAX(2 * window * window * busiestChunk, 1);
+
+    usize memory = sizeof(SimulationState);
+    memory += EcsWorldMemory(*entityCapacity, SimulationArchetypeCount, ComponentsRowSize());
+    memory += (header->spawnCount + 7) / 8;
+    memory += SimulationActorCapacity * (sizeof(SDL_FRect) + sizeof(bool) + 2 * sizeof(SweepEndpoint) + sizeof(Sprite *));
+    return memory;
+}
+
+void SimulationInit(Arena *arena, Simulation *sim, Arena *frameArena, JobSystem *jobs, TextureAtlas *atlas, Level *level, u32 tickRate, u32 rewindSeconds) {
+    sim->frameArena = frameArena;
+    sim->jobs = jobs;
+    sim->atlas = atlas;
+    InputActionsInit(&sim->actions);
+    memset(sim->systemTime, 0, sizeof(sim->systemTime));
+
+    // Everything that changes while playing goes in here and nowhere else, so it can be saved whole
+    u32 entityCapacity;
+    sim->stateArena = ArenaAlloc(SimulationStateMemory(level, &entityCapacity));
+    SimulationState *state = ArenaPushStruct(sim->stateArena, SimulationState);
+    sim->state = state;
+
+    // Get the capy sprite
+    Sprite capySprite;
+    SpriteFromAtlas(&capySprite, atlas, &STR("capy_idle"));
+
+    // Setup the player
+    PlayerInit(&state->player, &capySprite);
+
+    // Setup the player control
+    ControllableInit(&state->playerControl, &state->player.sprite.pos, &state->player.velocity, &state->player.grounded, &PlayerControl);
+
+    // Everything that isn't the player lives in the world
+    EcsWorldInit(sim->stateArena, &state->world, entityCapacity);
+    ComponentsRegister(&state->world);
+
+    // Systems record spawns and destroys here, they land between ticks
+    EcsCommandBufferInit(arena, &sim->commands, &state->world, 4096, 256 * Kilobyte);
+
+    // Walls only exist as solid tiles, straight out of the level file
+    LevelHeader *header = level->header;
+    sim->level = level;
+    TileMapInitInPlace(&sim->tileMap, header->width, header->height, header->tileSize, level->collision);
+
+    // Look up what the tile layer draws once, rather than by name every snapshot
+    sim->tileSprites = ArenaPushArray(arena, header->tileSpriteCount, Sprite);
+    for (u16 i = 0; i < header->tileSpriteCount; i++) {
+        String name = {strlen(level->tileSprites[i].name), level->tileSprites[i].name};
+        SpriteFromAtlas(&sim->tileSprites[i], atlas, &name);
+    }
+
+    // The player starts wherever the level says, everything else spawns as its chunk streams in
+    for (u32 i = 0; i < header->spawnCount; i++) {
+        LevelSpawn *spawn = &level->spawns[i];
+        if (spawn->kind == LevelSpawn_Player) {
+            Vec2 cell = {spawn->x * header->tileSize, spawn->y * header->tileSize};
+            state->player.sprite.pos = cell;
+            state->player.previousPos = cell;
+        }
+    }
+
+    state->consumedSpawns = ArenaPushArrayZero(sim->stateArena, (header->spawnCount + 7) / 8, u8);
+
+    // NOTE(SeedyROM): Cells are two tiles across and coins are smaller than a tile, so one never covers more than
+    // four cells. The hash is sized for every spawn in the level being a coin.
+    TextureAtlasFrames coinFrames = TextureAtlasIndicesGetFrames(atlas, &STR("coin"));
+    sim->coinSize = (Vec2){0, 0};
+    for (usize i = 0; i < coinFrames.len; i++) {
+        sim->coinSize.x = MAX(sim->coinSize.x, coinFrames.ptr[i].w);
+        sim->coinSize.y = MAX(sim->coinSize.y, coinFrames.ptr[i].h);
+    }
+    u32 coinCapacity = MAX(header->spawnCount, 1);
+    SpatialHashInit(arena, &sim->coinHash, header->tileSize * 2, coinCapacity, coinCapacity, coinCapacity * 4);
+    sim->coinEntities = ArenaPushArray(arena, coinCapacity, EcsEntity);
+    sim->coinHashDirty = true;
+
+    state->streamFocus = state->player.sprite.pos;
+    WorldStreamInit(arena, &sim->stream, level, SimulationActiveRadius, SimulationLoadRadius, SimulationActivateChunk, SimulationDeactivateChunk, sim);
+    WorldStreamUpdate(&sim->stream, state->streamFocus);
+
+    EcsCommandBufferApply(&sim->commands);
+    SimulationRebuildCoinHash(sim);
+
+    SweepAndPruneInit(sim->stateArena, &state->actors, SimulationActorCapacity);
+    state->actorSprites = ArenaPushArrayZero(sim->stateArena, SimulationActorCapacity, Sprite *);
+
+    Player *player = &state->player;
+    SDL_Rect playerFrame = player->sprite.frames.ptr[player->sprite.currentFrame];
+    SweepAndPruneAdd(&state->actors, 0, (SDL_FRect){player->sprite.pos.x, player->sprite.pos.y, playerFrame.w, playerFrame.h});
+    state->actorSprites[0] = &player->sprite;
+
+    // Nothing follows the player yet
+    state->camera = (Camera){.position = {0, 0}, .scale = {1, 1}, .rotation = 0};
+
+    // The simulation steps at a fixed rate no matter how fast we draw
+    SimClockInit(&sim->clock, tickRate);
+
+    // Saves copy however much of the state arena is in use, never more than all of it
+    ArenaSnapshotInit(arena, &sim->quickSave.arena, sim->stateArena->size);
+    ArenaSnapshotInit(arena, &sim->restartSave.arena, sim->stateArena->size);
+    sim->quickSave.valid = false;
+    SimulationSaveState(sim, &sim->restartSave);
+
+    // A keyframe a second, plus the one being filled so there's always rewindSeconds of history
+    sim->rewindEnabled = rewindSeconds > 0;
+    if (sim->rewindEnabled) {
+        RewindBufferInit(arena, &sim->rewind, sim->stateArena, tickRate, rewindSeconds + 1);
+        RewindBufferCapture(&sim->rewind, sim->clock.tick);
+    }
+}
+
+void SimulationSaveState(Simulation *sim, SimulationSave *save) {
+    ArenaSnapshotSave(&save->arena, sim->stateArena);
+    save->tick = sim->clock.tick;
+    save->valid = true;
+}
+
+void SimulationLoadState(Simulation *sim, SimulationSave *save) {
+    if (!save->valid) {
+        return;
+    }
+
+    // NOTE(SeedyROM): The state arena is the same memory it was saved from, so every pointer in it still points at the right thing.
+    ArenaSnapshotRestore(&save->arena, sim->stateArena);
+    sim->clock.tick = save->tick;
+
+    // The world has the entities of the chunks around where it was saved, make the stream agree
+    WorldStreamReset(&sim->stream, sim->state->streamFocus);
+    SimulationRebuildCoinHash(sim);
+
+    // The history belongs to the run that was just thrown away, start over from here
+    if (sim->rewindEnabled) {
+        RewindBufferClear(&sim->rewind);
+        RewindBufferCapture(&sim->rewind, sim->clock.tick);
+    }
+}
+
+bool SimulationRewindTo(Simulation *sim, u64 tick) {
+    if (!sim->rewindEnabled || !RewindBufferRestore(&sim->rewind, tick)) {
+        return false;
+    }
+
+    sim->clock.tick = tick;
+    WorldStreamReset(&sim->stream, sim->state->streamFocus);
+    SimulationRebuildCoinHash(sim);
+    return true;
+}
+
+void SimulationRewindCheckInit(Arena *arena, SimulationRewindCheck *check, u32 interval) {
+    check->interval = interval;
+    check->inputs = ArenaPushArray(arena, interval, InputFrame);
+    check->hashes = ArenaPushArray(arena, interval, u64);
+    check->checks = 0;
+    check->failures = 0;
+}
+
+// Keeps the tick that just ran on input, and every interval ticks steps back that far and runs them again, reporting
+// the first tick that comes out different
+void SimulationRewindCheckRun(SimulationRewindCheck *check, Simulation *sim, u64 tick, InputFrame *input) {
+    check->inputs[tick % check->interval] = *input;
+    check->hashes[tick % check->interval] = RewindBufferHashState(&sim->rewind);
+
+    u64 end = sim->clock.tick;
+    if (end < check->interval || end % check->interval != 0 || !SimulationRewindTo(sim, end - check->interval)) {
+        return;
+    }
+
+    check->checks++;
+    for (tick = end - check->interval; tick < end; tick++) {
+        SimulationTick(sim, &check->inputs[tick % check->interval]);
+
+        u64 hash = RewindBufferHashState(&sim->rewind);
+        if (hash != check->hashes[tick % check->interval]) {
+            printf("Rewind check: ticks %llu-%llu diverged at tick %llu\n", (unsigned long long)(end - check->interval),
+                   (unsigned long long)end, (unsigned long long)tick);
+            check->failures++;
+
+            // Carry on from the new state, it's as good as any
+            while (sim->clock.tick < end) {
+                SimulationTick(sim, &check->inputs[sim->clock.tick % check->interval]);
+            }
+            return;
+        }
+    }
+}
+
+// Quick save, quick load and restart, all of them between ticks
+static void SimulationHandleSaves(Simulation *sim) {
+    u8 pressed = sim->actions.pressed;
+    if (pressed == 0) {
+        return;
+    }
+
+    SimulationSave *save = NULL;
+    if (pressed & InputButton_Restart) {
+        save = &sim->restartSave;
+    } else if (pressed & InputButton_QuickLoad) {
+        save = &sim->quickSave;
+    } else if (pressed & InputButton_QuickSave) {
+        u64 start = SDL_GetPerformanceCounter();
+        SimulationSaveState(sim, &sim->quickSave);
+        printf("Saved tick %llu (%zu bytes) in %.1fus\n", (unsigned long long)sim->clock.tick, sim->quickSave.arena.used,
+               (f64)(SDL_GetPerformanceCounter() - start) * 1000000.0 / SDL_GetPerformanceFrequency());
+        return;
+    } else {
+        return;
+    }
+
+    if (!save->valid) {
+        printf("Nothing saved to load\n");
+        return;
+    }
+
+    u64 start = SDL_GetPerformanceCounter();
+    SimulationLoadState(sim, save);
+    printf("Loaded tick %llu (%zu bytes) in %.1fus\n", (unsigned long long)save->tick, save->arena.used,
+           (f64)(SDL_GetPerformanceCounter() - start) * 1000000.0 / SDL_GetPerformanceFrequency());
+}
+
+// Charge the time since the last lap to a system
+static inline void SimulationLap(Simulation *sim, SimSystem system, u64 *lapStart) {
+    u64 now = SDL_GetPerformanceCounter();
+    sim->systemTime[system] += now - *lapStart;
+    *lapStart = now;
+}
+
+void SimulationTick(Simulation *sim, InputFrame *input) {
+    // Everything this tick reads the same edges, however many things are controlled
+    InputActionsUpdate(&sim->actions, input);
+    SimulationHandleSaves(sim);
+
+    // Going back a tick instead of forward, whatever's stored after it gets simulated again on release
+    if (sim->rewindEnabled && (sim->actions.held & InputButton_Rewind)) {
+        if (sim->clock.tick > 0) {
+            SimulationRewindTo(sim, sim->clock.tick - 1);
+        }
+        return;
+    }
+
+    SimulationState *state = sim->state;
+    Player *player = &state->player;
+
+    ArenaClear(sim->frameArena);
+    player->previousPos = player->sprite.pos;
+
+    u64 lapStart = SDL_GetPerformanceCounter();
+
+    // This is awful but update the player sprite
+    if (sim->clock.tick % 20 == 0) {
+        SpriteNextFrame(&player->sprite);
+    }
+
+    // Bring chunks in and out around the player, the commands land with everything else's
+    ProfileBlock("WorldStream") {
+        state->streamFocus = player->sprite.pos;
+        WorldStreamUpdate(&sim->stream, state->streamFocus);
+    }
+    CountersSet(GameCounter_ChunksLoaded, WorldStreamCount(&sim->stream, StreamChunkState_Loaded) + WorldStreamCount(&sim->stream, StreamChunkState_Active));
+    CountersSet(GameCounter_ChunksActive, WorldStreamCount(&sim->stream, StreamChunkState_Active));
+    SimulationLap(sim, SimSystem_Stream, &lapStart);
+
+    // Update the player
+    ProfileBlock("UpdatePlayer") {
+        ControllableUpdate(&state->playerControl, &sim->actions);
+        PlayerUpdate(player, gravity);
+    }
+    SimulationLap(sim, SimSystem_Player, &lapStart);
+
+    // Run the world systems
+    ProfileBlock("Systems") {
+        CoinUpdate(&state->world, &sim->commands);
+        SpriteAnimateSystem(&state->world, sim->jobs, sim->frameArena);
+    }
+    SimulationLap(sim, SimSystem_World, &lapStart);
+
+    // Handle collisions
+    ProfileBlock("HandleActorCollisions") {
+        HandleActorCollisions(&state->actors, state->actorSprites, &sim->tileMap, sim->frameArena);
+    }
+    SimulationLap(sim, SimSystem_ActorCollisions, &lapStart);
+
+    ProfileBlock("HandleCollisions") {
+        HandleCollisions(player, &sim->tileMap, &state->world, &sim->coinHash, sim->coinEntities, sim->atlas, sim->frameArena);
+    }
+    SimulationLap(sim, SimSystem_TileCollisions, &lapStart);
+
+    // Sync point, nothing is iterating the world now
+    ProfileBlock("EcsCommandBufferApply") {
+        EcsCommandBufferApply(&sim->commands);
+    }
+
+    // Chunks came or went, their coins only exist now
+    if (sim->coinHashDirty) {
+        ProfileBlock("SimulationRebuildCoinHash") {
+            SimulationRebuildCoinHash(sim);
+        }
+    }
+    SimulationLap(sim, SimSystem_Commands, &lapStart);
+
+    sim->clock.tick++;
+
+    // Keep the state the next tick starts from
+    if (sim->rewindEnabled) {
+        ProfileBlock("RewindBufferCapture") {
+            RewindBufferCapture(&sim->rewind, sim->clock.tick);
+        }
+    }
+    SimulationLap(sim, SimSystem_Rewind, &lapStart);
+}
+
+void SimulationShutdown(Simulation *sim) {
+    // Stops the loader, the level itself belongs to whoever loaded it
+    WorldStreamDestroy(&sim->stream);
+    if (sim->rewindEnabled) {
+        RewindBufferFree(&sim->rewind);
+    }
+    ArenaFree(sim->stateArena);
+}
+
+// NOTE(SeedyROM): Fake player for benchmarks without a recording, runs back and forth hopping the whole time.
+void SimulationScriptedInput(InputFrame *input, u64 tick) {
+    *input = (InputFrame){0};
+
+    // Four seconds each way at 60Hz
+    input->buttons |= (tick / 240) % 2 == 0 ? InputButton_Right : InputButton_Left;
+    if (tick % 45 < 10) {
+        input->buttons |= InputButton_Up;
+    }
+}
+
+void SimulationReport(Simulation *sim, f64 elapsedSeconds) {
+    u64 ticks = sim->clock.tick;
+    f64 frequency = (f64)SDL_GetPerformanceFrequency();
+
+    printf("Simulated %llu ticks in %.3fs (%.0f ticks/s, %.1fx realtime)\n", (unsigned long long)ticks, elapsedSeconds,
+           elapsedSeconds > 0 ? ticks / elapsedSeconds : 0.0,
+           elapsedSeconds > 0 ? ticks / (elapsedSeconds * sim->clock.tickRate) : 0.0);
+
+    u64 total = 0;
+    for (u32 i = 0; i < SimSystem_Count; i++) {
+        total += sim->systemTime[i];
+    }
+
+    printf("%-20s %12s %12s %8s\n", "System", "Total (ms)", "Avg (us)", "Share");
+    for (u32 i = 0; i < SimSystem_Count; i++) {
+        f64 milliseconds = sim->systemTime[i] * 1000.0 / frequency;
+        f64 average = ticks > 0 ? sim->systemTime[i] * 1000000.0 / frequency / ticks : 0.0;
+        f64 share = total > 0 ? sim->systemTime[i] * 100.0 / total : 0.0;
+        printf("%-20s %12.3f %12.3f %7.1f%%\n", SimSystemNames[i], milliseconds, average, share);
+    }
+
+    if (sim->rewindEnabled && sim->rewind.storedBytes > 0) {
+        RewindBuffer *rewind = &sim->rewind;
+        printf("Rewind stored %.1fMB for %.1fMB of state (%.1fx smaller), holding ticks %llu-%llu\n",
+               rewind->storedBytes / (f64)Megabyte, rewind->rawBytes / (f64)Megabyte, (f64)rewind->rawBytes / rewind->storedBytes,
+               (unsigned long long)RewindBufferOldest(rewind), (unsigned long long)RewindBufferNewest(rewind));
+    }
+}
+
+void SimulationSnapshot(Simulation *sim, RenderSnapshot *snapshot) {
+    RenderSnapshotClear(snapshot);
+    snapshot->camera = sim->state->camera;
+    snapshot->tick = sim->clock.tick;
+    snapshot->counter = SDL_GetPerformanceCounter();
+    snapshot->entityCount = sim->state->world.entityCount;
+
+    // Same order as they're drawn: the world, the player, then the tiles
+    SpriteSnapshotSystem(&sim->state->world, snapshot);
+    RenderSnapshotPushSprite(snapshot, &sim->state->player.sprite, sim->state->player.previousPos);
+
+    // Only the tiles of active chunks, the rest of the level isn't there as far as drawing goes
+    WorldStream *stream = &sim->stream;
+    u16 tileSize = sim->level->header->tileSize;
+    for (u32 slot = 0; slot < STREAM_POOL_SIZE; slot++) {
+        StreamChunk *chunk = &stream->pool[slot];
+        if (atomic_load_explicit(&chunk->state, memory_order_acquire) != StreamChunkState_Active) {
+            continue;
+        }
+
+        for (i32 y = 0; y < stream->chunkSize; y++) {
+            for (i32 x = 0; x < stream->chunkSize; x++) {
+                u16 tile = chunk->tiles[y * stream->chunkSize + x];
+                if (tile != 0) {
+                    Sprite *tileSprite = &sim->tileSprites[tile - 1];
+                    tileSprite->pos = (Vec2){(chunk->chunkX * stream->chunkSize + x) * tileSize, (chunk->chunkY * stream->chunkSize + y) * tileSize};
+                    RenderSnapshotPushSprite(snapshot, tileSprite, tileSprite->pos);
+                }
+            }
+        }
+    }
+}
+
+// Plenty for every sprite in a level
+static const usize SimulationSnapshotMemory = 4 * Megabyte;
+
+void SimulationPipelineInit(Arena *arena, SimulationPipeline *pipeline, Simulation *sim, InputRecorder *inputRecorder) {
+    pipeline->sim = sim;
+    pipeline->inputRecorder = inputRecorder;
+    for (u32 i = 0; i < 3; i++) {
+        pipeline->snapshots[i] = RenderSnapshotCreate(arena, SimulationSnapshotMemory);
+    }
+    TripleBufferInit(&pipeline->buffer, pipeline->snapshots[0], pipeline->snapshots[1], pipeline->snapshots[2]);
+    atomic_init(&pipeline->input, 0);
+    atomic_init(&pipeline->inputSequence, 0);
+    atomic_init(&pipeline->running, false);
+    atomic_init(&pipeline->finished, false);
+    pipeline->thread = NULL;
+
+    // So there's something to draw before the first tick
+    SimulationSnapshot(sim, TripleBufferWriteBuffer(&pipeline->buffer));
+    TripleBufferPublish(&pipeline->buffer);
+}
+
+// One tick and a snapshot of it, false once a replay runs out
+bool SimulationPipelineStep(SimulationPipeline *pipeline, InputFrame *input) {
+    if (!InputRecorderNext(pipeline->inputRecorder, input)) {
+        atomic_store_explicit(&pipeline->finished, true, memory_order_release);
+        return false;
+    }
+
+    ProfileBlock("Tick") {
+        SimulationTick(pipeline->sim, input);
+    }
+
+    RenderSnapshot *snapshot = TripleBufferWriteBuffer(&pipeline->buffer);
+    SimulationSnapshot(pipeline->sim, snapshot);
+    snapshot->inputSequence = atomic_load_explicit(&pipeline->inputSequence, memory_order_relaxed);
+    TripleBufferPublish(&pipeline->buffer);
+
+    return true;
+}
+
+_Static_assert(sizeof(InputFrame) <= sizeof(u64), "InputFrame has to fit in the pipeline's input slot");
+
+// The input read is at least as new as the sequence returned. Takes the edges with it, the next tick only gets the
+// ones that happen after this
+static u64 SimulationPipelineReadInput(SimulationPipeline *pipeline, InputFrame *input) {
+    u64 sequence = atomic_load_explicit(&pipeline->inputSequence, memory_order_acquire);
+    u64 packed = atomic_load_explicit(&pipeline->input, memory_order_relaxed);
+    u64 taken;
+    do {
+        memcpy(input, &packed, sizeof(InputFrame));
+        InputFrame rest = *input;
+        rest.pressed = 0;
+        rest.released = 0;
+        taken = 0;
+        memcpy(&taken, &rest, sizeof(InputFrame));
+    } while (!atomic_compare_exchange_weak_explicit(&pipeline->input, &packed, taken, memory_order_relaxed, memory_order_relaxed));
+    return sequence;
+}
+
+static int SimulationPipelineThread(void *data) {
+    SimulationPipeline *pipeline = data;
+    Simulation *sim = pipeline->sim;
+
+    // Worker 0 moved here with the simulation
+    JobSystemAttachThread();
+    ProfileThreadName("capy-sim");
+
+    u64 inputSequence = 0;
+
+    while (atomic_load_explicit(&pipeline->running, memory_order_acquire)) {
+        u32 ticks = SimClockAdvance(&sim->clock);
+        if (ticks == 0) {
+            // Too early for the next tick, give the core back
+            SDL_Delay(1);
+            continue;
+        }
+
+        bool replaying = true;
+        for (u32 tick = 0; tick < ticks && replaying; tick++) {
+            InputFrame input;
+            inputSequence = SimulationPipelineReadInput(pipeline, &input);
+            replaying = InputRecorderNext(pipeline->inputRecorder, &input);
+            if (replaying) {
+                ProfileBlock("Tick") {
+                    SimulationTick(sim, &input);
+                }
+            }
+        }
+
+        // Only the last tick of a batch is worth drawing
+        ProfileBlock("SimulationSnapshot") {
+            RenderSnapshot *snapshot = TripleBufferWriteBuffer(&pipeline->buffer);
+            SimulationSnapshot(sim, snapshot);
+            snapshot->inputSequence = inputSequence;
+            TripleBufferPublish(&pipeline->buffer);
+        }
+
+        if (!replaying) {
+            atomic_store_explicit(&pipeline->finished, true, memory_order_release);
+            break;
+        }
+    }
+
+    JobSystemDetachThread();
+    return 0;
+}
+
+void SimulationPipelineStart(SimulationPipeline *pipeline) {
+    // NOTE(SeedyROM): The sim thread owns worker 0 until it's stopped, don't submit jobs from here in between.
+    JobSystemDetachThread();
+
+    atomic_store_explicit(&pipeline->running, true, memory_order_release);
+    pipeline->thread = SDL_CreateThread(SimulationPipelineThread, "capy-sim", pipeline);
+    if (pipeline->thread == NULL) {
+        fprintf(stderr, "SDL_CreateThread Error: %s\n", SDL_GetError());
+        exit(EXIT_FAILURE);
+    }
+}
+
+u64 SimulationPipelineSetInput(SimulationPipeline *pipeline, InputFrame *input) {
+    // NOTE(SeedyROM): Frames come faster than ticks, so the edges pile up on whatever the simulation hasn't taken yet
+    // instead of replacing them. Otherwise a tap that starts and ends between two ticks never happened.
+    u64 current = atomic_load_explicit(&pipeline->input, memory_order_relaxed);
+    u64 packed;
+    do {
+        InputFrame pending;
+        memcpy(&pending, &current, sizeof(InputFrame));
+        InputFrame merged = *input;
+        merged.pressed |= pending.pressed;
+        merged.released |= pending.released;
+        packed = 0;
+        memcpy(&packed, &merged, sizeof(InputFrame));
+    } while (!atomic_compare_exchange_weak_explicit(&pipeline->input, &current, packed, memory_order_relaxed, memory_order_relaxed));
+
+    // Only this thread writes it, the release publishes the input along with it
+    u64 sequence = atomic_load_explicit(&pipeline->inputSequence, memory_order_relaxed) + 1;
+    atomic_store_explicit(&pipeline->inputSequence, sequence, memory_order_release);
+    return sequence;
+}
+
+RenderSnapshot *SimulationPipelineLatest(SimulationPipeline *pipeline) {
+    return TripleBufferRead(&pipeline->buffer, NULL);
+}
+
+bool SimulationPipelineFinished(SimulationPipeline *pipeline) {
+    return atomic_load_explicit(&pipeline->finished, memory_order_acquire);
+}
+
+void SimulationPipelineStop(SimulationPipeline *pipeline) {
+    if (pipeline->thread != NULL) {
+        atomic_store_explicit(&pipeline->running, false, memory_order_release);
+        SDL_WaitThread(pipeline->thread, NULL);
+        pipeline->thread = NULL;
+        JobSystemAttachThread();
+    }
+
+    for (u32 i = 0; i < 3; i++) {
+        RenderSnapshotFree(pipeline->snapshots[i]);
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include "engine/engine.h"
+#include "game/behaviours.h"
+#include "game/components.h"
+#include "game/entities.h"
+#include "game/snapshot.h"
+#include "game/systems.h"
+
+// The parts of a tick, timed separately for the sim-only benchmark
+typedef enum SimSystem {
+  SimSystem_Stream = 0,
+  SimSystem_Player,
+  SimSystem_World,
+  SimSystem_ActorCollisions,
+  SimSystem_TileCollisions,
+  SimSystem_Commands,
+  SimSystem_Rewind,
+  SimSystem_Count,
+} SimSystem;
+
+// Everything gameplay carries from one tick to the next. It sits at the front
+// of the simulation's state arena with everything it points into behind it,
+// so saving the game is one memcpy of the arena and loading is another.
+typedef struct SimulationState {
+  Player player;
+  Controllable playerControl;
+  EcsWorld world;
+  // A bit per level spawn that's been used up, so it doesn't come back when its chunk does
+  u8 *consumedSpawns;
+  SweepAndPrune actors;
+  Sprite **actorSprites;
+  Camera camera;
+  // Where the stream was centred last tick, a load puts the same chunks back
+  Vec2 streamFocus;
+} SimulationState;
+
+// A saved SimulationState, only good for the simulation it came from
+typedef struct SimulationSave {
+  ArenaSnapshot arena;
+  u64 tick;
+  bool valid;
+} SimulationSave;
+
+// Everything a tick reads and writes, none of it needs a renderer
+typedef struct Simulation {
+  Arena *frameArena;
+  JobSystem *jobs;
+  TextureAtlas *atlas;
+  Arena *stateArena;
+  SimulationState *state;
+  // Always empty between ticks, so it isn't part of the state
+  EcsCommandBuffer commands;
+  Level *level;
+  TileMap tileMap;
+  WorldStream stream;
+  // What each id in the level's tile layer draws
+  Sprite *tileSprites;
+  // Coins that can still be picked up, by level spawn. Only ever built from the
+  // world, so it isn't part of the state and gets rebuilt whenever coins come
+  // or go in bulk (chunks streaming, loads, rewinds)
+  SpatialHash coinHash;
+  EcsEntity *coinEntities;
+  Vec2 coinSize;
+  bool coinHashDirty;
+  SimClock clock;
+  // Taken with F5, loaded with F9
+  SimulationSave quickSave;
+  // Taken straight after init, R goes back to it
+  SimulationSave restartSave;
+  // The last few seconds, one capture per tick, only when rewindEnabled
+  bool rewindEnabled;
+  RewindBuffer rewind;
+  // This tick's input as edges, saves and loads happen on the press and not every tick it's held
+  InputActions actions;
+  // Performance counter ticks spent in each system since init
+  u64 systemTime[SimSystem_Count];
+} Simulation;
+
+// Checking that re-simulating from the rewind buffer lands on the same state,
+// for hunting down nondeterminism
+typedef struct SimulationRewindCheck {
+  u32 interval;
+  // The input and the state hash of the last interval ticks, by tick
+  InputFrame *inputs;
+  u64 *hashes;
+  u32 checks;
+  u32 failures;
+} SimulationRewindCheck;
+
+// Runs ticks on their own thread while the main thread draws. SDL wants
+// rendering on the main thread, so the simulation is what moves. Each batch of
+// ticks ends with a snapshot handed over through a triple buffer, and input
+// comes the other way as the latest sampled frame, with the edges of every
+// frame since the last tick.
+typedef struct SimulationPipeline {
+  Simulation *sim;
+  InputRecorder *inputRecorder;
+  RenderSnapshot *snapshots[3];
+  TripleBuffer buffer;
+  // Latest InputFrame from the main thread, packed so it can be swapped whole.
+  // Its edges build up until a tick takes them
+  atomic_ullong input;
+  // Bumped with every input handed over, snapshots carry the last one the ticks saw
+  atomic_ullong inputSequence;
+  atomic_bool running;
+  // Set once a replay runs out of input
+  atomic_bool finished;
+  SDL_Thread *thread;
+} SimulationPipeline;
+
+void SimulationInit(Arena *arena, Simulation *sim, Arena *frameArena,
+                    JobSystem *jobs, TextureAtlas *atlas, Level *level,
+                    u32 tickRate, u32 rewindSeconds);
+void SimulationTick(Simulation *sim, InputFrame *input);
+void SimulationShutdown(Simulation *sim);
+void SimulationSaveState(Simulation *sim, SimulationSave *save);
+void SimulationLoadState(Simulation *sim, SimulationSave *save);
+bool SimulationRewindTo(Simulation *sim, u64 tick);
+void SimulationRewindCheckInit(Arena *arena, SimulationRewindCheck *check,
+                               u32 interval);
+void SimulationRewindCheckRun(SimulationRewindCheck *check, Simulation *sim,
+                              u64 tick, InputFrame *input);
+void SimulationScriptedInput(InputFrame *input, u64 tick);
+void SimulationReport(Simulation *sim, f64 elapsedSeconds);
+void SimulationSnapshot(Simulation *sim, RenderSnapshot *snapshot);
+
+void SimulationPipelineInit(Arena *arena, SimulationPipeline *pipeline,
+                            Simulation *sim, InputRecorder *inputRecorder);
+void SimulationPipelineStart(SimulationPipeline *pipeline);
+bool SimulationPipelineStep(SimulationPipeline *pipeline, InputFrame *input);
+u64 SimulationPipelineSetInput(SimulationPipeline *pipeline,
+                               InputFrame *input);
+RenderSnapshot *SimulationPipelineLatest(SimulationPipeline *pipeline);
+bool SimulationPipelineFinished(SimulationPipeline *pipeline);
+void SimulationPipelineStop(SimulationPipeline *pipeline);
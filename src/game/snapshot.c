@@ -0,0 +1,58 @@
+#include "snapshot.h"
+
+RenderSnapshot *RenderSnapshotCreate(Arena *arena, usize instanceMemory) {
+    RenderSnapshot *snapshot = ArenaPushStruct(arena, RenderSnapshot);
+    snapshot->arena = ArenaAlloc(instanceMemory);
+    snapshot->camera = (Camera){.position = {0, 0}, .scale = {1, 1}, .rotation = 0};
+    snapshot->tick = 0;
+    snapshot->counter = 0;
+    snapshot->inputSequence = 0;
+    snapshot->entityCount = 0;
+    snapshot->instances = NULL;
+    snapshot->count = 0;
+
+    return snapshot;
+}
+
+void RenderSnapshotClear(RenderSnapshot *snapshot) {
+    ArenaClear(snapshot->arena);
+    snapshot->instances = (SpriteInstance *)snapshot->arena->base;
+    snapshot->count = 0;
+}
+
+void RenderSnapshotPush(RenderSnapshot *snapshot, SpriteInstance *instance) {
+    // Pushed back to back, so they stay one array
+    *ArenaPushStruct(snapshot->arena, SpriteInstance) = *instance;
+    snapshot->count++;
+}
+
+void RenderSnapshotPushSprite(RenderSnapshot *snapshot, Sprite *sprite, Vec2 previousPos) {
+    SpriteInstance instance = {
+        .frames = sprite->frames,
+        .currentFrame = sprite->currentFrame,
+        .flipX = sprite->flipX,
+        .pos = sprite->pos,
+        .previousPos = previousPos};
+    RenderSnapshotPush(snapshot, &instance);
+}
+
+void RenderSnapshotDraw(RenderSnapshot *snapshot, TextureAtlas *atlas, SDL_Renderer *renderer, f32 alpha) {
+    Sprite sprite;
+    sprite.atlas = atlas;
+    sprite.scale = (Vec2){1, 1};
+    sprite.rotation = 0;
+    sprite.flipY = false;
+
+    for (u32 i = 0; i < snapshot->count; i++) {
+        SpriteInstance *instance = &snapshot->instances[i];
+        sprite.frames = instance->frames;
+        sprite.flipX = instance->flipX;
+        sprite.pos.x = instance->previousPos.x + (instance->pos.x - instance->previousPos.x) * alpha;
+        sprite.pos.y = instance->previousPos.y + (instance->pos.y - instance->previousPos.y) * alpha;
+        SpriteDrawFrame(&sprite, renderer, instance->currentFrame);
+    }
+}
+
+void RenderSnapshotFree(RenderSnapshot *snapshot) {
+    ArenaFree(snapshot->arena);
+}
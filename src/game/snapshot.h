@@ -0,0 +1,47 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include "engine/arena.h"
+#include "engine/gfx.h"
+#include "engine/util.h"
+
+typedef struct Camera {
+  Vec2 position;
+  Vec2 scale;
+  f32 rotation;
+} Camera;
+
+// One sprite to draw, copied out of the simulation so drawing never touches it
+typedef struct SpriteInstance {
+  TextureAtlasFrames frames;
+  u16 currentFrame;
+  bool flipX;
+  Vec2 pos;
+  // Where it was the tick before, drawing blends between the two
+  Vec2 previousPos;
+} SpriteInstance;
+
+// Everything drawn for one tick. Built at the end of a tick and never changed
+// after it's been handed to the renderer.
+typedef struct RenderSnapshot {
+  Arena *arena;
+  Camera camera;
+  u64 tick;
+  // Performance counter when the tick finished
+  u64 counter;
+  // Newest input the simulation had seen by then, for timing input latency
+  u64 inputSequence;
+  u32 entityCount;
+  SpriteInstance *instances;
+  u32 count;
+} RenderSnapshot;
+
+RenderSnapshot *RenderSnapshotCreate(Arena *arena, usize instanceMemory);
+void RenderSnapshotClear(RenderSnapshot *snapshot);
+void RenderSnapshotPush(RenderSnapshot *snapshot, SpriteInstance *instance);
+void RenderSnapshotPushSprite(RenderSnapshot *snapshot, Sprite *sprite,
+                              Vec2 previousPos);
+void RenderSnapshotDraw(RenderSnapshot *snapshot, TextureAtlas *atlas,
+                        SDL_Renderer *renderer, f32 alpha);
+void RenderSnapshotFree(RenderSnapshot *snapshot);
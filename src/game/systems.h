@@ -0,0 +1,3 @@
+#pragma once
+
+#include "systems/sprites.h"
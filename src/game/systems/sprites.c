@@ -0,0 +1,75 @@
+#include "sprites.h"
+
+typedef struct SpriteAnimateChunk {
+    TextureAtlasFrames *sprites;
+    Animation *animations;
+    u32 count;
+} SpriteAnimateChunk;
+
+static void SpriteAnimateJob(void *data, u32 start, u32 end) {
+    SpriteAnimateChunk *chunks = data;
+    ProfileBlock("SpriteAnimateJob") {
+        for (u32 chunkIndex = start; chunkIndex < end; chunkIndex++) {
+            SpriteAnimateChunk *chunk = &chunks[chunkIndex];
+            for (u32 i = 0; i < chunk->count; i++) {
+                Animation *animation = &chunk->animations[i];
+                if (animation->time % animation->frameDuration == 0) {
+                    animation->currentFrame = (animation->currentFrame + 1) % chunk->sprites[i].len;
+                }
+                animation->time += 1;
+            }
+        }
+    }
+}
+
+void SpriteAnimateSystem(EcsWorld *world, JobSystem *jobs, Arena *frameArena) {
+    // Collect the chunks first, they're pushed back to back so they form one array
+    SpriteAnimateChunk *chunks = NULL;
+    u32 chunkCount = 0;
+
+    EcsQuery query = EcsQueryBegin(world, EcsComponentBit(Component_Sprite) | EcsComponentBit(Component_Animation));
+    while (EcsQueryNext(&query)) {
+        SpriteAnimateChunk *chunk = ArenaPushStruct(frameArena, SpriteAnimateChunk);
+        chunk->sprites = EcsQueryColumnOf(&query, TextureAtlasFrames, Component_Sprite);
+        chunk->animations = EcsQueryColumnOf(&query, Animation, Component_Animation);
+        chunk->count = query.count;
+
+        if (chunks == NULL) {
+            chunks = chunk;
+        }
+        chunkCount++;
+    }
+
+    // Chunks don't share rows, so each one can go to its own worker
+    if (jobs != NULL && chunkCount > 1) {
+        JobCounter animated;
+        JobCounterInit(&animated);
+        JobSystemParallelFor(jobs, chunkCount, 1, SpriteAnimateJob, chunks, &animated);
+        JobSystemWait(jobs, &animated);
+    } else {
+        SpriteAnimateJob(chunks, 0, chunkCount);
+    }
+}
+
+// Copies out everything with a sprite, the renderer draws it while the next tick runs
+void SpriteSnapshotSystem(EcsWorld *world, RenderSnapshot *snapshot) {
+    EcsQuery query = EcsQueryBegin(world, EcsComponentBit(Component_Position) | EcsComponentBit(Component_Sprite));
+    while (EcsQueryNext(&query)) {
+        Vec2 *positions = EcsQueryColumnOf(&query, Vec2, Component_Position);
+        TextureAtlasFrames *sprites = EcsQueryColumnOf(&query, TextureAtlasFrames, Component_Sprite);
+
+        // Not everything with a sprite is animated
+        Animation *animations = EcsQueryColumnOf(&query, Animation, Component_Animation);
+
+        for (u32 i = 0; i < query.count; i++) {
+            // NOTE(SeedyROM): Nothing in the world moves yet, so it was where it is last tick too.
+            SpriteInstance instance = {
+                .frames = sprites[i],
+                .currentFrame = animations != NULL ? animations[i].currentFrame : 0,
+                .flipX = false,
+                .pos = positions[i],
+                .previousPos = positions[i]};
+            RenderSnapshotPush(snapshot, &instance);
+        }
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include "engine/arena.h"
+#include "engine/ecs.h"
+#include "engine/gfx.h"
+#include "engine/job.h"
+#include "game/components.h"
+#include "game/snapshot.h"
+
+void SpriteAnimateSystem(EcsWorld *world, JobSystem *jobs, Arena *frameArena);
+void SpriteSnapshotSystem(EcsWorld *world, RenderSnapshot *snapshot);
@@ -6,310 +6,290 @@
 #include "engine/engine.h"
 #include "game.h"
 
-static f32 gravity = 0.098f / 1.4f;
-
-bool IsCollision(Sprite *a, Sprite *b) {
-    SDL_Rect aRect = a->frames.ptr[a->currentFrame];
-    SDL_Rect bRect = b->frames.ptr[b->currentFrame];
-
-    // Use the center of the sprite for collision detection
-    aRect.x = a->pos.x + (aRect.w / 2);
-    aRect.y = a->pos.y + (aRect.h / 2);
-    bRect.x = b->pos.x + (bRect.w / 2);
-    bRect.y = b->pos.y + (bRect.h / 2);
-
-    if (aRect.x + aRect.w < bRect.x || bRect.x + bRect.w < aRect.x) {
-        return false;
-    }
-
-    if (aRect.y + aRect.h < bRect.y || bRect.y + bRect.h < aRect.y) {
-        return false;
-    }
-
-    return true;
-}
-
-// Add this function to check if there's ground below the player
-bool CheckGrounded(SDL_Rect playerRect, Wall walls[], int wallCount, Sprite wallSprite) {
-    // Create a small ray below the player to check for ground
-    SDL_Rect groundCheck = playerRect;
-    groundCheck.y = playerRect.y + playerRect.h;  // Position just below the player
-    groundCheck.h = 2;                            // Small height for ground detection
-
-    for (int i = 0; i < wallCount; i++) {
-        SDL_Rect wallRect = wallSprite.frames.ptr[wallSprite.currentFrame];
-        wallRect.x = walls[i].position.x;
-        wallRect.y = walls[i].position.y;
-
-        SDL_Rect overlap;
-        if (SDL_IntersectRect(&groundCheck, &wallRect, &overlap)) {
-            return true;
+// Ticks as fast as the simulation can go with nothing drawn, the gameplay throughput benchmark
+void RunSimulationOnly(Simulation *sim, InputRecorder *inputRecorder, u64 tickLimit, SimulationRewindCheck *check) {
+    u64 startCounter = SDL_GetPerformanceCounter();
+
+    while (tickLimit == 0 || sim->clock.tick < tickLimit) {
+        // Replays override the script, recordings capture it
+        InputFrame input;
+        SimulationScriptedInput(&input, sim->clock.tick);
+        if (!InputRecorderNext(inputRecorder, &input)) {
+            break;
         }
-    }
-
-    return false;
-}
 
-// Add this function to handle all collision checks and responses
-void HandleCollisions(Player *player, Wall walls[], int wallCount, Sprite wallSprite,
-                      EntityList *coinList, SDL_Rect *lastPlayerRect) {
-    SDL_Rect playerRect = player->sprite.frames.ptr[player->sprite.currentFrame];
-    playerRect.x = player->sprite.pos.x;
-    playerRect.y = player->sprite.pos.y;
-
-    // First handle wall collisions
-    for (int i = 0; i < wallCount; i++) {
-        Wall wall = walls[i];
-        SDL_Rect wallRect = wallSprite.frames.ptr[wallSprite.currentFrame];
-        wallRect.x = wall.position.x;
-        wallRect.y = wall.position.y;
-
-        SDL_Rect overlap = {0, 0, 0, 0};
-
-        if (!SDL_IntersectRect(&playerRect, &wallRect, &overlap)) {
-            continue;
+        u64 tick = sim->clock.tick;
+        ProfileBlock("Tick") {
+            SimulationTick(sim, &input);
         }
+        ProfileFrameEnd();
 
-        // Handle vertical collisions
-        if (lastPlayerRect->y + lastPlayerRect->h <= wallRect.y) {
-            player->sprite.pos.y = wallRect.y - playerRect.h;
-            player->velocity.y = 0;
-        } else if (lastPlayerRect->y >= wallRect.y + wallRect.h) {
-            player->sprite.pos.y = wallRect.y + wallRect.h;
-            player->velocity.y = 0;
+        if (check != NULL) {
+            SimulationRewindCheckRun(check, sim, tick, &input);
         }
 
-        // Update player rect after vertical resolution
-        playerRect.x = player->sprite.pos.x;
-        playerRect.y = player->sprite.pos.y;
-
-        // Handle horizontal collisions
-        if (SDL_IntersectRect(&playerRect, &wallRect, &overlap)) {
-            if (lastPlayerRect->x + lastPlayerRect->w <= wallRect.x) {
-                player->sprite.pos.x = wallRect.x - playerRect.w;
-                player->velocity.x = 0;
-            } else if (lastPlayerRect->x >= wallRect.x + wallRect.w) {
-                player->sprite.pos.x = wallRect.x + wallRect.w + 0.5f;
-                player->velocity.x = 0;
-            }
-        }
+        CountersSet(GameCounter_Entities, sim->state->world.entityCount);
+        CountersSet(GameCounter_FrameArenaBytes, sim->frameArena->used);
+        CountersSample(tick);
     }
 
-    // Update player rect one final time
-    playerRect.x = player->sprite.pos.x;
-    playerRect.y = player->sprite.pos.y;
-
-    // Check grounded state after all collisions are resolved
-    player->grounded = CheckGrounded(playerRect, walls, wallCount, wallSprite);
+    f64 elapsedSeconds = (f64)(SDL_GetPerformanceCounter() - startCounter) / SDL_GetPerformanceFrequency();
+    SimulationReport(sim, elapsedSeconds);
+    if (check != NULL) {
+        printf("Rewind check: %u of %u re-simulations diverged\n", check->failures, check->checks);
+    }
+}
 
-    // Handle coin collisions and collection
-    for (int i = coinList->count - 1; i >= 0; i--) {
-        Coin *coin = EntityListGetEntity(coinList, i + 1);
+int main(int argc, char *argv[]) {
+    GameOptions options;
+    if (GameParseOptions(&options, argc, argv) != 0) {
+        return 1;
+    }
 
-        // Update the coin first
-        CoinUpdate(coin);
+    Arena *globalArena = ArenaAlloc(128 * Megabyte);
 
-        // Remove collected coins
-        if (coin->delete) {
-            EntityListRemoveAtIndex(coinList, i);
-            continue;
-        }
+    // Does nothing unless built with CAPY_PROFILE
+    ProfileInit(globalArena);
 
-        // Check for collision with player and collect if touching
-        if (IsCollision(&player->sprite, &coin->sprite)) {
-            CoinCollect(coin);
-        }
+    // Per-frame counts, written out in the background when asked for
+    CountersInit(globalArena);
+    GameRegisterCounters();
+    if (options.countersPath != NULL && CountersStartWriter(options.countersPath) != 0) {
+        printf("Counters won't be written\n");
     }
 
-    // Update the last player rect
-    *lastPlayerRect = playerRect;
-}
+    // Scratch memory that only lives for one frame
+    Arena *frameArena = ArenaAlloc(16 * Megabyte);
 
-int main(void) {
-    Arena *globalArena = ArenaAlloc(128 * Megabyte);
+    // One worker per core, this thread included
+    JobSystem *jobs = JobSystemCreate(globalArena, 0);
 
     // Initialize the game
     Game game;
-    if (GameInit(&game) != 0) {
+    int initResult = 0;
+    if (options.simOnly) {
+        initResult = GameInitSimOnly(&game);
+    } else if (options.headless) {
+        initResult = GameInitHeadless(&game);
+    } else {
+        initResult = GameInit(&game, options.vsync);
+    }
+    if (initResult != 0) {
         printf("Failed to initialize capy-quest\n");
         return 1;
     }
 
     // Load the default controller
-    if (GameLoadDefaultController(&game) != 0) {
+    if (!game.headless && GameLoadDefaultController(&game) != 0) {
         printf("Failed to load default controller\n");
         printf("Will use keyboard controls instead\n");
     }
 
-    // Get the window, renderer and controller.
+    // Get the window and renderer, the controller stays in game.controller so there's only one handle to close
     SDL_Renderer *renderer = game.renderer;
-    SDL_GameController *controller = game.controller;
 
-    // Load the texture atlas from the assets folder
+    // Load the texture atlas from the assets folder, without a renderer this is just the frames and masks
     TextureAtlas *textureAtlas = TextureAtlasCreate(globalArena);
-    TextureAtlasLoadSprites(renderer, textureAtlas, &STR("../assets/sprites/*.aseprite"));
-
-    // Create the camera and set the position
-    Camera camera;
-    camera.position = (Vec2){0, 0};
-    camera.scale = (Vec2){1, 1};
-    camera.rotation = 0;
-
-    // Get the capy sprite
-    Sprite capySprite;
-    SpriteFromAtlas(&capySprite, textureAtlas, &STR("capy_idle"));
-
-    // Setup the player
-    Player player;
-    PlayerInit(&player, &capySprite);
-
-    // Setup the player control
-    Controllable playerControl;
-    ControllableInit(&playerControl, &player.sprite.pos, &player.velocity, &player.grounded, &PlayerControl);
-
-    // Coin entity list
-    EntityList coinList;
-    EntityListInit(globalArena, &coinList, sizeof(Coin), 32);
-
-    // Get the wall sprite
-    Sprite wallSprite;
-    SpriteFromAtlas(&wallSprite, textureAtlas, &STR("rock"));
-
-    // Create a simple map!
-    int map[32][16] = {
-        {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
-        {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1},
-        {1, 3, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 2, 1},
-        {1, 0, 0, 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1},
-        {1, 0, 0, 1, 1, 1, 1, 0, 0, 2, 0, 0, 0, 1, 0, 1},
-        {1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1},
-        {1, 0, 1, 0, 0, 0, 1, 0, 2, 0, 1, 0, 0, 0, 0, 1},
-        {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
-        {1, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
-        {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
-    };
-
-    // Create the walls
-    Wall walls[128];
-    int wallCount = 0;
-
-    // Add the objects to the map
-    for (int y = 0; y < 32; y++) {
-        for (int x = 0; x < 16; x++) {
-            int tile = map[y][x];
-            if (tile == 1) {
-                Wall wall;
-                WallInit(&wall, (Vec2){x * 16, y * 16});
-                walls[wallCount] = wall;
-                wallCount++;
-            }
+    ProfileBlock("TextureAtlasLoadSprites") {
+        TextureAtlasLoadSprites(renderer, jobs, textureAtlas, &STR("../assets/sprites/*.aseprite"));
+    }
+
+    // Map the level in, tiles are used straight out of the file
+    Level level;
+    u64 levelStart = SDL_GetPerformanceCounter();
+    if (LevelLoad(&level, options.levelPath) != 0) {
+        printf("Failed to load level %s\n", options.levelPath);
+        return 1;
+    }
+    printf("Loaded level %s (%ux%u) in %.3fms\n", options.levelPath, level.header->width, level.header->height,
+           (f64)(SDL_GetPerformanceCounter() - levelStart) * 1000.0 / SDL_GetPerformanceFrequency());
 
-            if (tile == 2) {
-                // Create a coin sprite, don't alloc.
-                Coin coin;
-                CoinInit(&coin, textureAtlas);
+    // The player, the world and the map
+    Simulation sim;
+    SimulationInit(globalArena, &sim, frameArena, jobs, textureAtlas, &level, GameTickRate, options.rewindSeconds);
 
-                // Put a coin randomly on the screen
-                coin.sprite.pos.x = x * 16 + 4;
-                coin.sprite.pos.y = y * 16 + 4;
+    // Frames drawn
+    u64 time = 0;
 
-                EntityListAdd(&coinList, &coin);
-            }
+    // The devices are only ever read through events, the simulation gets a copy of where they're at
+    InputState inputState;
+    InputStateInit(&inputState, game.controller != NULL);
+    InputLatency inputLatency;
+    InputLatencyInit(&inputLatency);
+
+    // Input is sampled once per tick, and can be written out or played back instead of the devices
+    InputRecorder inputRecorder;
+    InputRecorderInit(&inputRecorder);
+    if (options.recordPath != NULL && InputRecorderStartRecording(&inputRecorder, options.recordPath) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    if (options.replayPath != NULL && InputRecorderStartReplay(globalArena, &inputRecorder, options.replayPath) != 0) {
+        exit(EXIT_FAILURE);
+    }
 
-            if (tile == 3) {
-                player.sprite.pos.x = x * 16;
-                player.sprite.pos.y = y * 16;
-            }
-        }
+    // Headless runs read every frame back so it can be hashed and compared
+    FrameCapture *capture = NULL;
+    if (game.headless && renderer != NULL) {
+        capture = FrameCaptureCreate(globalArena, game.windowWidth, game.windowHeight);
     }
 
-    // Store the last player rect
-    SDL_Rect lastPlayerRect = {0, 0, 0, 0};
+    // Drawing only ever sees snapshots of the simulation
+    SimulationPipeline pipeline;
+    SimulationPipelineInit(globalArena, &pipeline, &sim, &inputRecorder);
 
-    // Dumb timer
-    u64 time = 0;
+    // Headless runs step exactly once per frame so captures don't depend on timing, otherwise the simulation gets its own thread
+    bool pipelined = !game.headless;
+    if (pipelined) {
+        SimulationPipelineStart(&pipeline);
+    }
+    u64 startCounter = SDL_GetPerformanceCounter();
 
     // Loop de loop
     SDL_Event event;
-    bool running = true;
+    bool running = !options.simOnly;
+    if (options.simOnly) {
+        SimulationRewindCheck rewindCheck;
+        if (options.rewindCheck != 0) {
+            SimulationRewindCheckInit(globalArena, &rewindCheck, options.rewindCheck);
+        }
+        RunSimulationOnly(&sim, &inputRecorder, options.tickLimit, options.rewindCheck != 0 ? &rewindCheck : NULL);
+    }
     while (running) {
         while (SDL_PollEvent(&event)) {
+            InputHandleEvent(&inputState, &event);
+
             // Quit this fucker
             if (event.type == SDL_QUIT) {
                 running = false;
             }
 
-            // Add the controller if it's plugged in
-            if (event.type == SDL_CONTROLLERDEVICEADDED) {
-                printf("Attempting to add controller\n");
-                controller = SDL_GameControllerOpen(0);
-                if (controller == NULL) {
-                    printf("Failed to add controller\n");
-                    fprintf(stderr, "SDL_JoystickOpen Error: %s\n", SDL_GetError());
-                }
+            // A new joystick gets its mapping now, SDL follows up with a controller added event if that made it one
+            if (event.type == SDL_JOYDEVICEADDED) {
+                ControllerDbRegister(&game.controllerDb, event.jdevice.which);
             }
 
-            // Remove the controller if it's unplugged
+            // Plugging one in only opens it if there isn't one already, unplugging only closes it if it was that one
+            bool controllerChanged = false;
+            if (event.type == SDL_CONTROLLERDEVICEADDED) {
+                controllerChanged = GameOpenController(&game, event.cdevice.which);
+            }
             if (event.type == SDL_CONTROLLERDEVICEREMOVED) {
-                printf("Controller disconnected\n");
-                SDL_GameControllerClose(controller);
-                controller = NULL;
+                controllerChanged = GameCloseController(&game, event.cdevice.which);
+            }
+            if (controllerChanged) {
+                InputStateSetController(&inputState, game.controller != NULL);
             }
         }
 
-        // This is awful but update the player sprite
-        if (time % 20 == 0) {
-            SpriteNextFrame(&player.sprite);
+        // Sampled every frame, the simulation picks up whatever's latest when it ticks
+        InputFrame input;
+        u64 inputChangedAt = InputStateSample(&inputState, &input);
+        u64 inputSequence = SimulationPipelineSetInput(&pipeline, &input);
+        InputLatencySent(&inputLatency, inputSequence, inputChangedAt);
+        if (pipelined) {
+            running = !SimulationPipelineFinished(&pipeline);
+        } else if (!SimulationPipelineStep(&pipeline, &input)) {
+            // Stop once a replay runs out of input, everything after that would be made up
+            running = false;
         }
 
-        // Update the player
-        ControllableUpdate(&playerControl, controller);
-        PlayerUpdate(&player, gravity);
+        RenderSnapshot *snapshot = SimulationPipelineLatest(&pipeline);
 
-        // Handle collisions
-        HandleCollisions(&player, walls, wallCount, wallSprite, &coinList, &lastPlayerRect);
+        // How far we are between the snapshot's tick and the next one
+        f32 alpha = 1.0f;
+        if (pipelined) {
+            f64 sinceTick = (f64)(SDL_GetPerformanceCounter() - snapshot->counter) / sim.clock.tickDuration;
+            alpha = MIN(MAX(sinceTick, 0.0), 1.0);
+        }
 
-        // Clear the screen
-        SDL_SetRenderDrawColor(renderer, 0, 128, 200, 255);
-        SDL_RenderClear(renderer);
+        ProfileBlock("Draw") {
+            // Clear the screen
+            SDL_SetRenderDrawColor(renderer, 0, 128, 200, 255);
+            SDL_RenderClear(renderer);
 
-        // Draw the coins
-        for (int i = 0; i < coinList.count; i++) {
-            // TODO(SeedyROM): This data should be iterated over the actual memory block
-            // instead of the references.
-            Coin *coin = EntityListGetEntity(&coinList, i + 1);
-            SpriteDrawFrame(&coin->sprite, renderer, coin->currentFrame);
+            // The coins, the player and the walls
+            RenderSnapshotDraw(snapshot, textureAtlas, renderer, alpha);
         }
 
-        // Draw the player
-        SpriteDraw(&player.sprite, renderer);
+        // Grab the frame before presenting, the backbuffer is gone afterwards
+        if (capture != NULL) {
+            ProfileBlock("FrameCapture") {
+                if (FrameCaptureRead(capture, renderer) != 0) {
+                    // The pixels are whatever was there last frame, don't hash or dump them
+                    fprintf(stderr, "Failed to capture frame %u\n", capture->frameIndex + 1);
+                    running = false;
+                } else {
+                    printf("Frame %u: %016llx\n", capture->frameIndex, (unsigned long long)capture->hash);
+
+                    if (options.captureDir != NULL) {
+                        char capturePath[512];
+                        snprintf(capturePath, sizeof(capturePath), "%s/frame_%05u.bmp", options.captureDir, capture->frameIndex);
+                        FrameCaptureWriteBMP(capture, &(String){strlen(capturePath), capturePath});
+                    }
+                }
+            }
+        }
 
-        // Draw the walls
-        for (int i = 0; i < wallCount; i++) {
-            wallSprite.pos = walls[i].position;
-            SpriteDraw(&wallSprite, renderer);
+        // Update the screen, this waits on vsync unless it's turned off
+        ProfileBlock("RenderPresent") {
+            SDL_RenderPresent(renderer);
         }
+        ProfileFrameEnd();
 
-        // Update the screen
-        SDL_RenderPresent(renderer);
+        // Once the input a snapshot saw is on screen, that's how long it took
+        u64 latency = InputLatencyPresented(&inputLatency, snapshot->inputSequence, SDL_GetPerformanceCounter());
+        if (latency != 0) {
+            CountersSet(GameCounter_InputLatency, latency * 1000000 / SDL_GetPerformanceFrequency());
+        }
 
-        // 60 FPS
-        SDL_Delay(16);
+        // Gauges are read off once a frame, then everything goes to the writer
+        CountersSet(GameCounter_Entities, snapshot->entityCount);
+        CountersSet(GameCounter_GlobalArenaBytes, globalArena->used);
+        CountersSet(GameCounter_FrameArenaBytes, frameArena->used);
+        CountersSample(time);
 
         // Time keeps on slipping, slipping, slipping...
         time++;
+
+        if (options.frameLimit != 0 && time >= options.frameLimit) {
+            running = false;
+        }
+    }
+
+    // Join the simulation before reading anything off it
+    SimulationPipelineStop(&pipeline);
+    SimulationShutdown(&sim);
+
+    // Report how long the frames took
+    if (!options.simOnly) {
+        f64 elapsedSeconds = (f64)(SDL_GetPerformanceCounter() - startCounter) / SDL_GetPerformanceFrequency();
+        printf("Ran %llu frames in %.3fs (%.3fms/frame)\n", (unsigned long long)time, elapsedSeconds, time > 0 ? elapsedSeconds * 1000.0 / time : 0.0);
+        printf("Simulated %llu ticks at %uHz\n", (unsigned long long)sim.clock.tick, sim.clock.tickRate);
+        InputLatencyReport(&inputLatency);
     }
 
-    // Clear the coins entity list
-    EntityListClear(&coinList);
+    // Flush the recording
+    InputRecorderClose(&inputRecorder);
 
     // Free the texture atlas
     TextureAtlasFree(textureAtlas);
 
+    // Stop the workers and flush the counters
+    JobSystemDestroy(jobs);
+    CountersStopWriter();
+
+    // Where the frame time went, once nothing else is writing zones
+    ProfileReport();
+    if (options.tracePath != NULL) {
+        ProfileWriteChromeTrace(options.tracePath);
+    }
+
     // Shutdown the game
+    LevelUnload(&level);
     GameShutdown(&game);
 
     // Clean up memory
+    ArenaFree(frameArena);
     ArenaFree(globalArena);
 
     return 0;
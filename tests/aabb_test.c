@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "engine/aabb.h"
+
+#define CHECK(condition)                                                   \
+    if (!(condition)) {                                                    \
+        fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+        return 1;                                                          \
+    }
+
+// Small whole numbers so plenty of boxes only touch, which mustn't count
+static SDL_FRect AABBTestRandomBox(void) {
+    return (SDL_FRect){(f32)(rand() % 32), (f32)(rand() % 32), (f32)(rand() % 8), (f32)(rand() % 8)};
+}
+
+// Written out the obvious way, what every path has to agree with
+static bool AABBTestOverlaps(SDL_FRect a, SDL_FRect b) {
+    return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+// Every count up to a few lanes past the widest, so each remainder gets hit
+static int TestOverlapBoxMatchesScalar(Arena *arena) {
+    SDL_FRect boxes[64];
+    AABBBatch batch;
+    AABBBatchInit(arena, &batch, 64);
+
+    for (u32 count = 0; count <= 64; count++) {
+        for (u32 round = 0; round < 50; round++) {
+            AABBBatchClear(&batch);
+            for (u32 i = 0; i < count; i++) {
+                boxes[i] = AABBTestRandomBox();
+                CHECK(AABBBatchPush(&batch, boxes[i]) == i);
+            }
+
+            SDL_FRect query = AABBTestRandomBox();
+            u32 hitCount = AABBBatchOverlapBox(&batch, query);
+
+            // Hits come back in index order, so walk both at once
+            u32 expected = 0;
+            for (u32 i = 0; i < count; i++) {
+                if (!AABBTestOverlaps(boxes[i], query)) {
+                    continue;
+                }
+
+                CHECK(expected < hitCount);
+                CHECK(batch.hits[expected] == i);
+                expected++;
+            }
+            CHECK(expected == hitCount);
+        }
+    }
+
+    return 0;
+}
+
+int main(void) {
+#if defined(__AVX__) && (defined(__GNUC__) || defined(__clang__))
+    if (!__builtin_cpu_supports("avx")) {
+        printf("No AVX on this CPU, skipping\n");
+        return 0;
+    }
+#endif
+
+    Arena *arena = ArenaAlloc(1 * Megabyte);
+    srand(1234);
+
+    int failures = 0;
+    failures += TestOverlapBoxMatchesScalar(arena);
+
+    ArenaFree(arena);
+    if (failures > 0) {
+        printf("%d AABB tests failed\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "engine/commands.h"
+#include "engine/ecs.h"
+
+#define CHECK(condition)                                                   \
+    if (!(condition)) {                                                    \
+        fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+        return 1;                                                          \
+    }
+
+// Starting bigger than one chunk means growing during init and again while spawning
+static int TestGrowPastStartingCapacity(void) {
+    Arena *arena = ArenaAlloc(64 * Megabyte);
+    EcsWorld world;
+    EcsWorldInit(arena, &world, ECS_CHUNK_SIZE + ECS_CHUNK_SIZE / 2);
+    EcsRegisterComponent(&world, 0, sizeof(u32));
+    CHECK(world.entityCapacity == ECS_CHUNK_SIZE * 2);
+
+    u32 count = ECS_CHUNK_SIZE * 3 + 1;
+    EcsEntity *entities = malloc(count * sizeof(EcsEntity));
+    bool *seen = calloc(ECS_CHUNK_SIZE * 4, sizeof(bool));
+    for (u32 i = 0; i < count; i++) {
+        entities[i] = EcsSpawn(&world, EcsComponentBit(0));
+        CHECK(entities[i].index < world.entityCapacity);
+        CHECK(!seen[entities[i].index]);
+        seen[entities[i].index] = true;
+        *EcsGetComponent(&world, entities[i], u32, 0) = i;
+    }
+    CHECK(world.entityCount == count);
+
+    // Every other one goes, then the holes get filled again
+    for (u32 i = 0; i < count; i += 2) {
+        EcsDestroy(&world, entities[i]);
+    }
+    for (u32 i = 0; i < count; i += 2) {
+        EcsEntity entity = EcsSpawn(&world, EcsComponentBit(0));
+        CHECK(!EcsIsAlive(&world, entities[i]));
+        CHECK(entity.index < world.entityCapacity);
+        *EcsGetComponent(&world, entity, u32, 0) = i;
+        entities[i] = entity;
+    }
+
+    for (u32 i = 0; i < count; i++) {
+        CHECK(EcsIsAlive(&world, entities[i]));
+        CHECK(*EcsGetComponent(&world, entities[i], u32, 0) == i);
+    }
+
+    free(seen);
+    free(entities);
+    ArenaFree(arena);
+    return 0;
+}
+
+// A handle to a destroyed entity mustn't touch whatever reused its record
+static int TestStaleCommandsSkipRecycledEntity(void) {
+    Arena *arena = ArenaAlloc(16 * Megabyte);
+    EcsWorld world;
+    EcsWorldInit(arena, &world, 16);
+    EcsRegisterComponent(&world, 0, sizeof(u32));
+    EcsRegisterComponent(&world, 1, sizeof(u32));
+
+    EcsEntity stale = EcsSpawn(&world, EcsComponentBit(0));
+    EcsDestroy(&world, stale);
+    EcsEntity live = EcsSpawn(&world, EcsComponentBit(0));
+    CHECK(live.index == stale.index);
+
+    EcsCommandBuffer commands;
+    EcsCommandBufferInit(arena, &commands, &world, 8, 256);
+    u32 liveValue = 9;
+    u32 staleValue = 7;
+    EcsCommandSet(&commands, live, 0, &liveValue);
+    EcsCommandAdd(&commands, stale, 1);
+    EcsCommandSet(&commands, stale, 0, &staleValue);
+    EcsCommandBufferApply(&commands);
+
+    CHECK(EcsIsAlive(&world, live));
+    CHECK(!EcsHas(&world, live, 1));
+    CHECK(*EcsGetComponent(&world, live, u32, 0) == liveValue);
+
+    ArenaFree(arena);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+    failures += TestGrowPastStartingCapacity();
+    failures += TestStaleCommandsSkipRecycledEntity();
+
+    if (failures > 0) {
+        printf("%d ECS tests failed\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <stdio.h>
+
+#include "engine/job.h"
+
+#define CHECK(condition)                                                   \
+    if (!(condition)) {                                                    \
+        fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+        return 1;                                                          \
+    }
+
+typedef struct JobTestLog {
+    atomic_int next;
+    int order[64];
+} JobTestLog;
+
+static void JobTestRecord(void *data, u32 start, u32 end) {
+    JobTestLog *log = data;
+    (void)end;
+    int slot = atomic_fetch_add(&log->next, 1);
+    log->order[slot] = start;
+}
+
+static void JobTestRecordAfter(void *data, u32 start, u32 end) {
+    JobTestLog *log = data;
+    (void)start;
+    (void)end;
+    int slot = atomic_fetch_add(&log->next, 1);
+    log->order[slot] = -1;
+}
+
+// One link of a chain, checks the link before it finished first
+typedef struct JobTestLink {
+    JobCounter *after;
+    atomic_int *total;
+    atomic_int *early;
+} JobTestLink;
+
+static void JobTestAdd(void *data, u32 start, u32 end) {
+    JobTestLink *link = data;
+    if (link->after != NULL && atomic_load(&link->after->value) != 0) {
+        atomic_fetch_add(link->early, 1);
+    }
+    atomic_fetch_add(link->total, end - start);
+}
+
+// With one worker there's nobody else to run the dependency, it has to come first
+static int TestDependencyOneWorker(Arena *arena) {
+    JobSystem *jobs = JobSystemCreate(arena, 1);
+
+    JobTestLog log;
+    atomic_init(&log.next, 0);
+
+    JobCounter first;
+    JobCounter second;
+    JobCounterInit(&first);
+    JobCounterInit(&second);
+    JobSystemParallelFor(jobs, 4, 1, JobTestRecord, &log, &first);
+    JobSystemRunAfter(jobs, &first, JobTestRecordAfter, &log, &second);
+    JobSystemWait(jobs, &second);
+
+    CHECK(JobCounterIsDone(&first));
+    CHECK(atomic_load(&log.next) == 5);
+    for (int i = 0; i < 4; i++) {
+        CHECK(log.order[i] >= 0 && log.order[i] < 4);
+    }
+    CHECK(log.order[4] == -1);
+
+    JobSystemDestroy(jobs);
+    return 0;
+}
+
+// Chains of dependencies across every worker, each link only runs after the last
+static int TestDependencyChains(Arena *arena) {
+    JobSystem *jobs = JobSystemCreate(arena, 4);
+
+    for (u32 round = 0; round < 200; round++) {
+        atomic_int total;
+        atomic_int early;
+        atomic_init(&total, 0);
+        atomic_init(&early, 0);
+
+        JobCounter counters[8];
+        JobTestLink links[8];
+        for (u32 i = 0; i < 8; i++) {
+            JobCounterInit(&counters[i]);
+            links[i] = (JobTestLink){i > 0 ? &counters[i - 1] : NULL, &total, &early};
+        }
+
+        JobSystemParallelFor(jobs, 256, 16, JobTestAdd, &links[0], &counters[0]);
+        for (u32 i = 1; i < 8; i++) {
+            JobSystemRunAfter(jobs, &counters[i - 1], JobTestAdd, &links[i], &counters[i]);
+        }
+        JobSystemWait(jobs, &counters[7]);
+
+        CHECK(atomic_load(&total) == 256 + 7);
+        CHECK(atomic_load(&early) == 0);
+    }
+
+    JobSystemDestroy(jobs);
+    return 0;
+}
+
+int main(void) {
+    Arena *arena = ArenaAlloc(64 * Megabyte);
+
+    int failures = 0;
+    failures += TestDependencyOneWorker(arena);
+    failures += TestDependencyChains(arena);
+
+    ArenaFree(arena);
+    if (failures > 0) {
+        printf("%d job tests failed\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
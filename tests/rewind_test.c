@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "engine/rewind.h"
+
+#define CHECK(condition)                                                   \
+    if (!(condition)) {                                                    \
+        fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+        return 1;                                                          \
+    }
+
+// NOTE(SeedyROM): A segment only has room for one keyframe of the whole arena and shares it with the deltas,
+// so the arena is kept well bigger than what's used. That way no segment runs out of room and starts the next
+// keyframe early, and the ticks land in the segments the tests expect.
+#define REWIND_TEST_STATE_SIZE (16 * Kilobyte)
+#define REWIND_TEST_MAX_USED 4096
+#define REWIND_TEST_TICKS 64
+
+// Four ticks a segment and four segments, so a run of 14 ticks has a keyframe
+// at 0, 4, 8 and 12 with everything from tick 0 still held
+static const u32 RewindTestInterval = 4;
+static const u32 RewindTestSegments = 4;
+
+// What the state arena held at each tick, kept whole to check restores against
+typedef struct RewindTestHistory {
+  u8 bytes[REWIND_TEST_TICKS][REWIND_TEST_MAX_USED];
+  usize used[REWIND_TEST_TICKS];
+} RewindTestHistory;
+
+// Moves used to the given size, anything newly in use gets junk in it like a fresh push would
+static void RewindTestResize(Arena *state, usize used) {
+    if (used > state->used) {
+        usize grow = used - state->used;
+        u8 *bytes = ArenaPush(state, grow);
+        for (usize i = 0; i < grow; i++) {
+            bytes[i] = (u8)rand();
+        }
+    } else {
+        ArenaSetPositionBack(state, used);
+    }
+}
+
+// A few bytes change each tick, which is what the deltas are there for
+static void RewindTestStep(Arena *state) {
+    u8 *bytes = state->base;
+    for (u32 i = 0; i < 8; i++) {
+        bytes[rand() % state->used] = (u8)rand();
+    }
+}
+
+static void RewindTestCapture(RewindBuffer *rewind, RewindTestHistory *history, u64 tick) {
+    Arena *state = rewind->state;
+    memcpy(history->bytes[tick], state->base, state->used);
+    history->used[tick] = state->used;
+    RewindBufferCapture(rewind, tick);
+}
+
+static bool RewindTestMatches(Arena *state, RewindTestHistory *history, u64 tick) {
+    return state->used == history->used[tick] && memcmp(state->base, history->bytes[tick], state->used) == 0;
+}
+
+// Sizes a tick's state gets, not word multiples and bigger and smaller than the keyframe they follow
+static usize RewindTestUsed(u64 tick) {
+    static const usize sizes[] = {2048, 2051, 1500, 3001, 2048, 997, 4096, 1024, 2600, 2601, 800, 3333, 1200, 4000};
+    return sizes[tick % (sizeof(sizes) / sizeof(sizes[0]))];
+}
+
+// count ticks from firstTick on, the size moves around every tick
+static void RewindTestRun(RewindBuffer *rewind, RewindTestHistory *history, u64 firstTick, u64 count) {
+    for (u64 tick = firstTick; tick < firstTick + count; tick++) {
+        RewindTestResize(rewind->state, RewindTestUsed(tick));
+        RewindTestStep(rewind->state);
+        RewindTestCapture(rewind, history, tick);
+    }
+}
+
+// Every tick held comes back exactly, keyframes and the deltas in between
+static int TestRestoreEveryTick(Arena *arena, Arena *state, RewindTestHistory *history) {
+    for (u64 target = 0; target < 14; target++) {
+        usize position = ArenaGetPosition(arena);
+        RewindBuffer rewind;
+        ArenaClear(state);
+        RewindBufferInit(arena, &rewind, state, RewindTestInterval, RewindTestSegments);
+
+        RewindTestRun(&rewind, history, 0, 14);
+        CHECK(RewindBufferOldest(&rewind) == 0);
+        CHECK(RewindBufferNewest(&rewind) == 13);
+
+        // Scribble over it first so nothing can pass by being left alone
+        memset(state->base, 0xAB, state->size);
+        CHECK(RewindBufferRestore(&rewind, target));
+        CHECK(RewindTestMatches(state, history, target));
+
+        // Whatever came after is gone, whatever came before is still there
+        CHECK(RewindBufferNewest(&rewind) == target);
+        CHECK(RewindBufferOldest(&rewind) == 0);
+        CHECK(!RewindBufferHas(&rewind, target + 1));
+
+        RewindBufferFree(&rewind);
+        ArenaSetPositionBack(arena, position);
+    }
+
+    return 0;
+}
+
+// Growing past the keyframe's size and shrinking back within one segment, then
+// going back to each of those ticks in turn from newest to oldest
+static int TestUsedShrinksAndGrows(Arena *arena, Arena *state, RewindTestHistory *history) {
+    usize position = ArenaGetPosition(arena);
+    RewindBuffer rewind;
+    ArenaClear(state);
+    RewindBufferInit(arena, &rewind, state, 8, 2);
+
+    static const usize sizes[] = {1024, 4096, 512, 3000, 8, 2049, 1024, 4095};
+    for (u64 tick = 0; tick < 8; tick++) {
+        RewindTestResize(state, sizes[tick]);
+        RewindTestStep(state);
+        RewindTestCapture(&rewind, history, tick);
+    }
+    CHECK(RewindBufferOldest(&rewind) == 0);
+    CHECK(rewind.current == 0);
+
+    for (u64 tick = 8; tick-- > 0;) {
+        memset(state->base, 0xCD, state->size);
+        CHECK(RewindBufferRestore(&rewind, tick));
+        CHECK(RewindTestMatches(state, history, tick));
+    }
+
+    RewindBufferFree(&rewind);
+    ArenaSetPositionBack(arena, position);
+    return 0;
+}
+
+// A different future after going back, stored against the restored keyframe,
+// and the ticks from before the restore still there underneath it
+static int TestCaptureAfterRestore(Arena *arena, Arena *state, RewindTestHistory *history) {
+    usize position = ArenaGetPosition(arena);
+    RewindBuffer rewind;
+    ArenaClear(state);
+    RewindBufferInit(arena, &rewind, state, RewindTestInterval, RewindTestSegments);
+
+    // Tick 6 is the middle of the second segment
+    RewindTestRun(&rewind, history, 0, 14);
+    CHECK(RewindBufferRestore(&rewind, 6));
+    CHECK(RewindTestMatches(state, history, 6));
+
+    // Carry on from there with different sizes than the first time round, this
+    // fills the rest of the segment and wraps past the oldest one. Tick 7 is
+    // bigger than the newest keyframe was, so it has to be stored against tick 4's
+    for (u64 tick = 7; tick < 20; tick++) {
+        RewindTestResize(state, RewindTestUsed(tick + 6));
+        RewindTestStep(state);
+        RewindTestCapture(&rewind, history, tick);
+    }
+    CHECK(RewindBufferNewest(&rewind) == 19);
+    CHECK(RewindBufferOldest(&rewind) == 4);
+
+    for (u64 tick = 19; tick >= 4; tick--) {
+        memset(state->base, 0xEF, state->size);
+        CHECK(RewindBufferRestore(&rewind, tick));
+        CHECK(RewindTestMatches(state, history, tick));
+    }
+    CHECK(!RewindBufferRestore(&rewind, 3));
+
+    // Skipping a tick, like loading a save does, starts the history over
+    RewindTestResize(state, 1000);
+    RewindTestCapture(&rewind, history, 30);
+    CHECK(RewindBufferOldest(&rewind) == 30);
+    CHECK(!RewindBufferHas(&rewind, 4));
+
+    RewindBufferFree(&rewind);
+    ArenaSetPositionBack(arena, position);
+    return 0;
+}
+
+int main(void) {
+    Arena *arena = ArenaAlloc(4 * Megabyte);
+    Arena *state = ArenaAlloc(REWIND_TEST_STATE_SIZE);
+    RewindTestHistory *history = ArenaPushStruct(arena, RewindTestHistory);
+    srand(1234);
+
+    int failures = 0;
+    failures += TestRestoreEveryTick(arena, state, history);
+    failures += TestUsedShrinksAndGrows(arena, state, history);
+    failures += TestCaptureAfterRestore(arena, state, history);
+
+    ArenaFree(state);
+    ArenaFree(arena);
+    if (failures > 0) {
+        printf("%d rewind tests failed\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
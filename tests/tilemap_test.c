@@ -0,0 +1,83 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "engine/tilemap.h"
+
+#define CHECK(condition)                                                   \
+    if (!(condition)) {                                                    \
+        fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+        return 1;                                                          \
+    }
+
+// A shaft one tile wide with a wall down its right side and a floor near the bottom.
+// Falling down it sweeps past a solid tile every row before it gets to the floor
+static int TestLongSweepHitsFloor(Arena *arena, Arena *frameArena) {
+    TileMap map;
+    TileMapInit(arena, &map, 3, 320, 16);
+    for (i32 y = 0; y < 320; y++) {
+        TileMapSetFlags(&map, 2, y, TileFlag_Solid);
+    }
+    for (i32 x = 0; x < 3; x++) {
+        TileMapSetFlags(&map, x, 300, TileFlag_Solid);
+    }
+
+    CollisionMover mover = {.box = {16, 0, 16, 16}, .delta = {0, 16 * 310}};
+    CHECK(TileMapCountCells(&map, CollisionGetSweptBounds(mover.box, mover.delta)) > 256);
+    TileMapMove(&map, frameArena, &mover, 1);
+
+    CHECK(mover.box.y + mover.box.h <= 300 * 16);
+    CHECK(mover.box.y + mover.box.h > 300 * 16 - 1);
+    CHECK(mover.normal.y == -1);
+    CHECK(frameArena->used == 0);
+    return 0;
+}
+
+static int TestRaycast(Arena *arena) {
+    TileMap map;
+    TileMapInit(arena, &map, 10, 10, 16);
+    TileMapSetFlags(&map, 5, 2, TileFlag_Solid);
+    TileMapSetFlags(&map, 2, 7, TileFlag_Solid);
+
+    // Straight along a row into the side of a tile
+    TileMapHit hit;
+    CHECK(TileMapRaycast(&map, (Vec2){8, 40}, (Vec2){1, 0}, 1000, &hit));
+    CHECK(hit.cellX == 5 && hit.cellY == 2);
+    CHECK(fabsf(hit.distance - 72) < 0.01f);
+    CHECK(hit.normal.x == -1 && hit.normal.y == 0);
+
+    // Down onto the top of one, the direction doesn't have to be normalised
+    CHECK(TileMapRaycast(&map, (Vec2){40, 8}, (Vec2){0, 3}, 1000, &hit));
+    CHECK(hit.cellX == 2 && hit.cellY == 7);
+    CHECK(fabsf(hit.distance - 104) < 0.01f);
+    CHECK(hit.normal.x == 0 && hit.normal.y == -1);
+
+    // Too short to get there, off the map, and no direction at all
+    CHECK(!TileMapRaycast(&map, (Vec2){8, 40}, (Vec2){1, 0}, 50, NULL));
+    CHECK(!TileMapRaycast(&map, (Vec2){8, 8}, (Vec2){-1, -1}, 1000, NULL));
+    CHECK(!TileMapRaycast(&map, (Vec2){8, 40}, (Vec2){0, 0}, 1000, NULL));
+
+    // Diagonal, steps into the tile from the side it crosses last
+    TileMapSetFlags(&map, 6, 6, TileFlag_Solid);
+    CHECK(TileMapRaycast(&map, (Vec2){8, 4}, (Vec2){1, 1}, 1000, &hit));
+    CHECK(hit.cellX == 6 && hit.cellY == 6);
+    CHECK(hit.normal.x == 0 && hit.normal.y == -1);
+    return 0;
+}
+
+int main(void) {
+    Arena *arena = ArenaAlloc(4 * Megabyte);
+    Arena *frameArena = ArenaAlloc(4 * Megabyte);
+
+    int failures = 0;
+    failures += TestLongSweepHitsFloor(arena, frameArena);
+    failures += TestRaycast(arena);
+
+    ArenaFree(frameArena);
+    ArenaFree(arena);
+    if (failures > 0) {
+        printf("%d tilemap tests failed\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
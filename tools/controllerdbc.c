@@ -0,0 +1,195 @@
+// Turns SDL_GameControllerDB's text file into the binary table
+// src/engine/controllerdb.h maps in, keeping only one platform's mappings.
+//
+// Usage: capy-controllerdbc <gamecontrollerdb.txt> <platform> <gamecontrollerdb.capypad>
+//
+// The platform is spelled the way SDL_GetPlatform() and the "platform:" field
+// spell it, e.g. "Linux", "Mac OS X" or "Windows". When the same GUID shows
+// up more than once the last one wins, same as feeding the file to SDL.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine/controllerdb.h"
+
+typedef struct ControllerLine {
+    u8 guid[16];
+    char *text;
+    u32 order;
+} ControllerLine;
+
+static u32 AlignUp4(u32 value) {
+    return (value + 3) & ~3u;
+}
+
+static char *ReadWholeFile(const char *path, usize *size) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *text = malloc(*size + 1);
+    if (fread(text, 1, *size, file) != *size) {
+        fprintf(stderr, "Failed to read %s\n", path);
+        fclose(file);
+        free(text);
+        return NULL;
+    }
+    text[*size] = '\0';
+    fclose(file);
+
+    return text;
+}
+
+static int HexDigit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+
+    return -1;
+}
+
+// 32 hex digits then a comma, the way SDL writes them
+static bool ParseGuid(const char *text, u8 *guid) {
+    for (u32 i = 0; i < 16; i++) {
+        int high = HexDigit(text[i * 2]);
+        int low = HexDigit(text[i * 2 + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        guid[i] = (u8)(high << 4 | low);
+    }
+
+    return text[32] == ',';
+}
+
+static bool IsForPlatform(const char *line, const char *platform) {
+    const char *field = strstr(line, "platform:");
+    if (field == NULL) {
+        return false;
+    }
+
+    field += strlen("platform:");
+    usize length = strlen(platform);
+    return strncmp(field, platform, length) == 0 && (field[length] == ',' || field[length] == '\0');
+}
+
+static int CompareLines(const void *a, const void *b) {
+    const ControllerLine *lineA = a;
+    const ControllerLine *lineB = b;
+    int order = memcmp(lineA->guid, lineB->guid, sizeof(lineA->guid));
+    if (order != 0) {
+        return order;
+    }
+
+    return lineA->order < lineB->order ? -1 : lineA->order > lineB->order;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 4) {
+        fprintf(stderr, "Usage: %s <gamecontrollerdb.txt> <platform> <gamecontrollerdb.capypad>\n", argv[0]);
+        return 1;
+    }
+
+    const char *platform = argv[2];
+    if (strlen(platform) >= CONTROLLER_DB_PLATFORM_LENGTH) {
+        fprintf(stderr, "Platform name is too long: %s\n", platform);
+        return 1;
+    }
+
+    usize textSize = 0;
+    char *text = ReadWholeFile(argv[1], &textSize);
+    if (text == NULL) {
+        return 1;
+    }
+
+    // Keep this platform's lines, everything else is comments or for somewhere else
+    u32 totalCount = 0;
+    u32 lineCount = 0;
+    ControllerLine *lines = malloc((textSize / 33 + 1) * sizeof(ControllerLine));
+    for (char *line = strtok(text, "\r\n"); line != NULL; line = strtok(NULL, "\r\n")) {
+        if (line[0] == '#') {
+            continue;
+        }
+
+        ControllerLine *parsed = &lines[lineCount];
+        if (strlen(line) < 33 || !ParseGuid(line, parsed->guid)) {
+            continue;
+        }
+
+        totalCount++;
+        if (!IsForPlatform(line, platform)) {
+            continue;
+        }
+
+        parsed->text = line;
+        parsed->order = lineCount;
+        lineCount++;
+    }
+
+    // By GUID, and within a GUID in file order so the last one can win
+    qsort(lines, lineCount, sizeof(ControllerLine), CompareLines);
+    u32 entryCount = 0;
+    u32 mappingsSize = 0;
+    for (u32 i = 0; i < lineCount; i++) {
+        if (i + 1 < lineCount && memcmp(lines[i].guid, lines[i + 1].guid, sizeof(lines[i].guid)) == 0) {
+            continue;
+        }
+
+        lines[entryCount++] = lines[i];
+        mappingsSize += strlen(lines[i].text) + 1;
+    }
+
+    ControllerDbHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CONTROLLER_DB_MAGIC, sizeof(CONTROLLER_DB_MAGIC));
+    header.version = ControllerDbVersion;
+    snprintf(header.platform, CONTROLLER_DB_PLATFORM_LENGTH, "%s", platform);
+    header.entryCount = entryCount;
+    header.entriesOffset = AlignUp4(sizeof(ControllerDbHeader));
+    header.mappingsOffset = AlignUp4(header.entriesOffset + entryCount * sizeof(ControllerDbEntry));
+    header.mappingsSize = mappingsSize;
+    header.fileSize = header.mappingsOffset + mappingsSize;
+
+    u8 *data = calloc(header.fileSize, 1);
+    memcpy(data, &header, sizeof(header));
+
+    ControllerDbEntry *entries = (ControllerDbEntry *)(data + header.entriesOffset);
+    char *mappings = (char *)(data + header.mappingsOffset);
+    u32 mappingOffset = 0;
+    for (u32 i = 0; i < entryCount; i++) {
+        u32 length = strlen(lines[i].text);
+        memcpy(entries[i].guid, lines[i].guid, sizeof(entries[i].guid));
+        entries[i].mappingOffset = mappingOffset;
+        entries[i].mappingLength = length;
+        memcpy(mappings + mappingOffset, lines[i].text, length + 1);
+        mappingOffset += length + 1;
+    }
+
+    FILE *output = fopen(argv[3], "wb");
+    if (output == NULL || fwrite(data, 1, header.fileSize, output) != header.fileSize) {
+        fprintf(stderr, "Failed to write %s\n", argv[3]);
+        return 1;
+    }
+    fclose(output);
+
+    printf("%s: %u of %u mappings for %s, %u bytes\n", argv[3], entryCount, totalCount, platform, header.fileSize);
+
+    free(data);
+    free(lines);
+    free(text);
+
+    return 0;
+}
@@ -0,0 +1,234 @@
+// Turns a text level into the binary format src/engine/level.h maps in.
+//
+// Usage: capy-levelc <level.txt> <level.capylvl>
+//
+// Lines starting with ';' are comments, "tilesize N" sets the tile size,
+// "chunksize N" the size of the streamed chunks in tiles, and every other line
+// is a row of tiles, one character each. Short rows are padded with nothing,
+// blank lines are skipped.
+//
+//   .  nothing        #  rock (solid)
+//   c  coin           p  player start
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine/level.h"
+#include "engine/tilemap.h"
+
+typedef struct LevelTileKind {
+    char symbol;
+    // NULL for tiles with nothing drawn
+    const char *sprite;
+    u8 flags;
+    // -1 when nothing spawns here
+    i32 spawn;
+} LevelTileKind;
+
+static const LevelTileKind LevelTileKinds[] = {
+    {'.', NULL, 0, -1},
+    {'#', "rock", TileFlag_Solid, -1},
+    {'c', NULL, 0, LevelSpawn_Coin},
+    {'p', NULL, 0, LevelSpawn_Player},
+};
+
+static const u32 LevelTileKindCount = sizeof(LevelTileKinds) / sizeof(LevelTileKinds[0]);
+
+static i32 LevelTileKindFind(char symbol) {
+    for (u32 k = 0; k < LevelTileKindCount; k++) {
+        if (LevelTileKinds[k].symbol == symbol) {
+            return k;
+        }
+    }
+
+    return -1;
+}
+
+static u32 AlignUp4(u32 value) {
+    return (value + 3) & ~3u;
+}
+
+static char *ReadWholeFile(const char *path, usize *size) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *text = malloc(*size + 1);
+    if (fread(text, 1, *size, file) != *size) {
+        fprintf(stderr, "Failed to read %s\n", path);
+        fclose(file);
+        free(text);
+        return NULL;
+    }
+    text[*size] = '\0';
+    fclose(file);
+
+    return text;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <level.txt> <level.capylvl>\n", argv[0]);
+        return 1;
+    }
+
+    usize textSize = 0;
+    char *text = ReadWholeFile(argv[1], &textSize);
+    if (text == NULL) {
+        return 1;
+    }
+
+    // Split into lines in place and size the map
+    u32 lineCount = 0;
+    char **lines = malloc((textSize + 1) * sizeof(char *));
+    for (char *line = strtok(text, "\r\n"); line != NULL; line = strtok(NULL, "\r\n")) {
+        lines[lineCount++] = line;
+    }
+
+    u16 tileSize = 16;
+    u16 chunkSize = 16;
+    u32 width = 0;
+    u32 height = 0;
+    char **rows = malloc((lineCount + 1) * sizeof(char *));
+    for (u32 i = 0; i < lineCount; i++) {
+        if (lines[i][0] == ';') {
+            continue;
+        }
+        if (strncmp(lines[i], "tilesize ", 9) == 0) {
+            tileSize = atoi(lines[i] + 9);
+            continue;
+        }
+        if (strncmp(lines[i], "chunksize ", 10) == 0) {
+            chunkSize = atoi(lines[i] + 10);
+            continue;
+        }
+
+        rows[height++] = lines[i];
+        width = MAX(width, strlen(lines[i]));
+    }
+
+    if (width == 0 || height == 0 || width > 0xFFFF || height > 0xFFFF || tileSize == 0) {
+        fprintf(stderr, "%s: level has to be between 1x1 and 65535x65535 tiles\n", argv[1]);
+        return 1;
+    }
+    if (chunkSize == 0) {
+        fprintf(stderr, "%s: chunks need at least one tile\n", argv[1]);
+        return 1;
+    }
+    u32 chunksX = (width + chunkSize - 1) / chunkSize;
+    u32 chunksY = (height + chunkSize - 1) / chunkSize;
+
+    // Count what goes in the sections
+    u16 tileSpriteCount = 0;
+    u16 tileSpriteIds[sizeof(LevelTileKinds) / sizeof(LevelTileKinds[0])];
+    for (u32 k = 0; k < LevelTileKindCount; k++) {
+        tileSpriteIds[k] = LevelTileKinds[k].sprite != NULL ? ++tileSpriteCount : 0;
+    }
+
+    u32 spawnCount = 0;
+    for (u32 y = 0; y < height; y++) {
+        for (char *c = rows[y]; *c != '\0'; c++) {
+            i32 k = LevelTileKindFind(*c);
+            if (k < 0) {
+                fprintf(stderr, "%s:%u:%u: unknown tile '%c'\n", argv[1], y + 1, (u32)(c - rows[y]) + 1, *c);
+                return 1;
+            }
+            if (LevelTileKinds[k].spawn >= 0) {
+                spawnCount++;
+            }
+        }
+    }
+
+    // Lay out the file
+    u32 cells = width * height;
+    LevelHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+    header.version = LevelVersion;
+    header.width = width;
+    header.height = height;
+    header.tileSize = tileSize;
+    header.tileSpriteCount = tileSpriteCount;
+    header.layerOffsets[LevelLayer_Collision] = AlignUp4(sizeof(LevelHeader));
+    header.layerOffsets[LevelLayer_Tiles] = AlignUp4(header.layerOffsets[LevelLayer_Collision] + cells * sizeof(u8));
+    header.tileSpritesOffset = AlignUp4(header.layerOffsets[LevelLayer_Tiles] + cells * sizeof(u16));
+    header.spawnsOffset = AlignUp4(header.tileSpritesOffset + tileSpriteCount * sizeof(LevelName));
+    header.spawnCount = spawnCount;
+    header.chunkSize = chunkSize;
+    header.chunksX = chunksX;
+    header.chunksY = chunksY;
+    header.chunksOffset = AlignUp4(header.spawnsOffset + spawnCount * sizeof(LevelSpawn));
+    header.fileSize = header.chunksOffset + chunksX * chunksY * sizeof(LevelChunk);
+
+    u8 *data = calloc(header.fileSize, 1);
+    memcpy(data, &header, sizeof(header));
+
+    u8 *collision = data + header.layerOffsets[LevelLayer_Collision];
+    u16 *tiles = (u16 *)(data + header.layerOffsets[LevelLayer_Tiles]);
+    LevelName *tileSprites = (LevelName *)(data + header.tileSpritesOffset);
+    LevelSpawn *spawns = (LevelSpawn *)(data + header.spawnsOffset);
+    LevelChunk *chunks = (LevelChunk *)(data + header.chunksOffset);
+
+    for (u32 k = 0; k < LevelTileKindCount; k++) {
+        if (tileSpriteIds[k] != 0) {
+            snprintf(tileSprites[tileSpriteIds[k] - 1].name, LEVEL_NAME_LENGTH, "%s", LevelTileKinds[k].sprite);
+        }
+    }
+
+    // Count the spawns in each chunk so each one gets its own run
+    for (u32 y = 0; y < height; y++) {
+        u32 rowLength = strlen(rows[y]);
+        for (u32 x = 0; x < rowLength; x++) {
+            if (LevelTileKinds[LevelTileKindFind(rows[y][x])].spawn >= 0) {
+                chunks[(y / chunkSize) * chunksX + x / chunkSize].spawnCount++;
+            }
+        }
+    }
+
+    u32 *chunkCursors = calloc(chunksX * chunksY, sizeof(u32));
+    u32 firstSpawn = 0;
+    for (u32 i = 0; i < chunksX * chunksY; i++) {
+        chunks[i].firstSpawn = firstSpawn;
+        chunkCursors[i] = firstSpawn;
+        firstSpawn += chunks[i].spawnCount;
+    }
+
+    // Within a chunk spawns stay in row major order, the order the game spawns them in
+    for (u32 y = 0; y < height; y++) {
+        u32 rowLength = strlen(rows[y]);
+        for (u32 x = 0; x < rowLength; x++) {
+            i32 k = LevelTileKindFind(rows[y][x]);
+            const LevelTileKind *kind = &LevelTileKinds[k];
+            collision[y * width + x] = kind->flags;
+            tiles[y * width + x] = tileSpriteIds[k];
+            if (kind->spawn >= 0) {
+                u32 chunk = (y / chunkSize) * chunksX + x / chunkSize;
+                spawns[chunkCursors[chunk]++] = (LevelSpawn){.kind = kind->spawn, .x = x, .y = y};
+            }
+        }
+    }
+
+    FILE *output = fopen(argv[2], "wb");
+    if (output == NULL || fwrite(data, 1, header.fileSize, output) != header.fileSize) {
+        fprintf(stderr, "Failed to write %s\n", argv[2]);
+        return 1;
+    }
+    fclose(output);
+
+    printf("%s: %ux%u tiles, %ux%u chunks, %u spawns, %u bytes\n", argv[2], width, height, chunksX, chunksY, spawnCount, header.fileSize);
+
+    free(chunkCursors);
+    free(data);
+    free(rows);
+    free(lines);
+    free(text);
+
+    return 0;
+}